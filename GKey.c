@@ -25,6 +25,8 @@
   CJB: 18-Apr-15: Assertions are now provided by debug.h.
   CJB: 21-Apr-16: Substituted format specifier %zu for %lu to avoid the need
                   to cast the matching parameter.
+  CJB: 16-Oct-26: Added strings for GKeyStatus_NoMem,
+                  GKeyStatus_Suspended and GKeyStatus_VerifyFailed.
 */
 
 /* ISO library header files */
@@ -60,7 +62,10 @@ const char *GKey_get_status_str(GKeyStatus status)
     "TruncatedInput",
     "BufferOverflow",
     "Aborted",
-    "Finished"
+    "Finished",
+    "NoMem",
+    "Suspended",
+    "VerifyFailed"
   };
   assert(status < ARRAY_SIZE(strings));
   return strings[status - GKeyStatus_OK];
@@ -24,6 +24,14 @@ History:
   CJB: 22-Nov-10: Created this header file.
   CJB: 07-Jan-11: Added the GKey_get_status_str function as a debugging aid.
   CJB: 06-Dec-20: Clarified documentation of GKeyStatus.
+  CJB: 16-Oct-26: Added GKeyAllocator and GKey_set_allocator().
+                  Added GKeyPool, GKey_pool_destroy() and
+                  GKey_pool_get_stats().
+                  Added GKeyStatus_NoMem, and types used by the callback
+                  streaming interface.
+                  Added GKeyVecParameters and related types.
+                  Added GKeyStatus_Suspended and GKeyStatus_VerifyFailed.
+                  Added GKeyTrace, GKey_trace_init() and GKey_trace_save().
 */
 
 #ifndef GKey_h
@@ -32,6 +40,7 @@ History:
 /* ISO library headers */
 #include <stddef.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 typedef enum
 {
@@ -43,7 +52,13 @@ typedef enum
   GKeyStatus_BufferOverflow, /* Output buffer was too small to write all of
                                 the output produced so far. */
   GKeyStatus_Aborted,        /* Operation aborted by a callback. */
-  GKeyStatus_Finished        /* No further input will be accepted. */
+  GKeyStatus_Finished,       /* No further input will be accepted. */
+  GKeyStatus_NoMem,          /* Not enough free memory. */
+  GKeyStatus_Suspended,      /* Stopped after doing as much work as allowed
+                                for one call (can be resumed by calling
+                                again). */
+  GKeyStatus_VerifyFailed    /* Decompressing the output did not reproduce
+                                the input. */
 }
 GKeyStatus;
    /*
@@ -90,6 +105,247 @@ GKeyParameters;
     * to provide more input data or a new output buffer may be required.
     */
 
+typedef bool GKeyReadFn(void *arg, void *buffer, size_t size, size_t *n);
+   /*
+    * Type of function called back to read up to 'size' bytes of input into
+    * 'buffer'. The number of bytes read must be stored at 'n'; it should
+    * only be 0 at the end of the input. If this function returns false
+    * (e.g. because of a read error) then the operation will be aborted.
+    */
+
+typedef bool GKeyWriteFn(void *arg, const void *buffer, size_t n);
+   /*
+    * Type of function called back to write 'n' bytes of output from
+    * 'buffer'. If this function returns false (e.g. because of a write
+    * error) then the operation will be aborted.
+    */
+
+typedef struct
+{
+  GKeyReadFn     *read_cb;  /* A function to be called to read input. */
+  GKeyWriteFn    *write_cb; /* A function to be called to write output. */
+  GKeyProgressFn *prog_cb;  /* A function to be called to indicate progress
+                               during the operation, or a null pointer. */
+  void           *cb_arg;   /* Context argument to be passed to all of the
+                               above callback functions. */
+}
+GKeyStreamParameters;
+   /*
+    * GKeyStreamParameters is an object that specifies how to read input
+    * and write output when compressing or decompressing a whole stream of
+    * data in one call.
+    */
+
+typedef struct
+{
+  const void *base; /* Address of the start of the segment */
+  size_t      size; /* Size of the segment, in bytes */
+}
+GKeyInVec;
+   /*
+    * GKeyInVec is an object that describes one segment of an input buffer
+    * which is split into several segments.
+    */
+
+typedef struct
+{
+  void  *base; /* Address of the start of the segment */
+  size_t size; /* Size of the segment, in bytes */
+}
+GKeyOutVec;
+   /*
+    * GKeyOutVec is an object that describes one segment of an output buffer
+    * which is split into several segments.
+    */
+
+typedef struct
+{
+  const GKeyInVec  *in_vec;  /* Array of input segments. Updated to point to
+                                the first with any data not consumed. */
+  size_t            in_count; /* No. of input segments. Updated to reflect
+                                 the no. not wholly consumed. */
+  size_t            in_offset; /* Offset of the data not consumed within the
+                                  first input segment. Updated. */
+  const GKeyOutVec *out_vec; /* Array of output segments. Updated to point to
+                                the first with any free space. */
+  size_t            out_count; /* No. of output segments. Updated to reflect
+                                  the no. not wholly filled. */
+  size_t            out_offset; /* Offset of the free space within the first
+                                   output segment. Updated. */
+  GKeyProgressFn   *prog_cb; /* A function to be called to indicate progress
+                                during the operation, or a null pointer. */
+  void             *cb_arg;  /* Context argument to be passed to the progress
+                                callback function. */
+}
+GKeyVecParameters;
+   /*
+    * GKeyVecParameters is an object that specifies arrays of input and
+    * output buffer segments (e.g. chains of network buffers) to be treated
+    * as though each array were one contiguous buffer. The offsets should
+    * initially be 0.
+    */
+
+typedef void *GKeyAllocFn(void *arg, size_t size);
+   /*
+    * Type of function called to allocate 'size' bytes of memory suitably
+    * aligned for any type of object.
+    * Returns: address of the allocated memory, or NULL if not enough memory.
+    */
+
+typedef void GKeyFreeFn(void *arg, void *ptr);
+   /*
+    * Type of function called to free memory at 'ptr' previously allocated
+    * by the corresponding GKeyAllocFn. Never called with a null pointer.
+    */
+
+typedef struct
+{
+  GKeyAllocFn *alloc; /* Function to allocate memory */
+  GKeyFreeFn  *free;  /* Function to free memory */
+  void        *arg;   /* Context argument to be passed to both functions */
+}
+GKeyAllocator;
+   /*
+    * GKeyAllocator is an object that specifies how to allocate and free the
+    * memory used by compressors and decompressors.
+    */
+
+void GKey_set_allocator(const GKeyAllocator */*allocator*/);
+   /*
+    * Sets the allocator to be used by compressors and decompressors created
+    * subsequently without an allocator of their own. The object pointed to by
+    * 'allocator' is copied. If 'allocator' is a null pointer then malloc and
+    * free are used, which is the default. Each compressor or decompressor
+    * keeps using the allocator with which it was created until destroyed.
+    * This function isn't thread-safe, so it should be called before creating
+    * any compressors or decompressors.
+    */
+
+typedef struct GKeyPool GKeyPool;
+   /*
+    * Opaque definition of a pool of compressors or decompressors that can
+    * be reused instead of being destroyed and recreated.
+    */
+
+typedef void GKeyLockFn(void *arg);
+   /*
+    * Type of function called to acquire or release a lock.
+    */
+
+typedef struct
+{
+  GKeyLockFn *lock;   /* Function to acquire a lock, e.g. a mutex */
+  GKeyLockFn *unlock; /* Function to release the same lock */
+  void       *arg;    /* Context argument to be passed to both functions */
+}
+GKeyPoolLock;
+   /*
+    * GKeyPoolLock is an object that specifies how to serialize access to a
+    * pool which is shared between threads. The lock is only held while
+    * updating the pool's list of free objects and its statistics.
+    */
+
+typedef struct
+{
+  unsigned long hits;   /* No. of requests satisfied by reusing an object */
+  unsigned long misses; /* No. of requests that created a new object */
+  size_t        nfree;  /* No. of objects currently waiting to be reused */
+}
+GKeyPoolStats;
+   /*
+    * GKeyPoolStats is an object that holds statistics about a pool.
+    */
+
+void GKey_pool_destroy(GKeyPool */*pool*/);
+   /*
+    * Destroys a pool of compressors or decompressors, including any objects
+    * waiting to be reused. Objects not returned to the pool are unaffected
+    * and must be destroyed individually. Does nothing if called with a null
+    * pointer.
+    */
+
+void GKey_pool_get_stats(GKeyPool */*pool*/, GKeyPoolStats */*stats*/);
+   /*
+    * Gets statistics about a specified pool of compressors or
+    * decompressors.
+    */
+
+typedef enum
+{
+  GKeyTraceType_Call,     /* Entered a function to compress or decompress
+                             data: arg1 is the input size and arg2 is the
+                             output size. */
+  GKeyTraceType_Return,   /* Returning: arg1 is the status and arg2 is the
+                             output size remaining. */
+  GKeyTraceType_State,    /* Changed state: arg1 is the old state. */
+  GKeyTraceType_Literal,  /* Decided to put a literal value: arg1 is the
+                             value. */
+  GKeyTraceType_Literals, /* Decided to put a sequence from the history as
+                             literal values: arg1 is the offset and arg2 is
+                             the size. */
+  GKeyTraceType_Copy,     /* Decided to put a copy command: arg1 is the
+                             offset and arg2 is the size. */
+  GKeyTraceType_Stall     /* Ran out of input while searching for a
+                             sequence: arg1 is the offset and arg2 is the
+                             size of the partial match. */
+}
+GKeyTraceType;
+
+typedef enum
+{
+  GKeyTraceSource_Comp,   /* Event recorded by a compressor */
+  GKeyTraceSource_Decomp  /* Event recorded by a decompressor */
+}
+GKeyTraceSource;
+
+typedef struct
+{
+  unsigned char type;   /* One of the values of GKeyTraceType */
+  unsigned char source; /* One of the values of GKeyTraceSource */
+  signed char   state;  /* Internal state of the source after the event */
+  uint32_t      pos;    /* Total no. of bytes consumed (by a compressor) or
+                           output (by a decompressor), modulo 2^32 */
+  uint32_t      arg1;   /* Depends on the type of event */
+  uint32_t      arg2;   /* Ditto */
+}
+GKeyTraceEvent;
+
+typedef struct
+{
+  GKeyTraceEvent *events; /* Array in which events are recorded */
+  size_t          size;   /* No. of elements in the array (a power of 2) */
+  size_t          count;  /* Total no. of events recorded. If greater than
+                             'size' then the oldest were overwritten. */
+}
+GKeyTrace;
+   /*
+    * GKeyTrace is an object that specifies a ring of events recorded by one
+    * or more compressors or decompressors, for which tracing is enabled by
+    * gkeycomp_set_trace() or gkeydecomp_set_trace(). Events are recorded in
+    * a compact binary form which can be saved by GKey_trace_save() and
+    * decoded by the TraceDump tool.
+    */
+
+void GKey_trace_init(GKeyTrace      */*trace*/,
+                     GKeyTraceEvent */*events*/,
+                     size_t          /*size*/);
+   /*
+    * Initializes a ring of events in an array of 'size' elements, which
+    * must be a power of 2. The array must remain valid as long as any
+    * compressor or decompressor records events in the ring.
+    */
+
+bool GKey_trace_save(const GKeyTrace */*trace*/,
+                     GKeyWriteFn     */*write_cb*/,
+                     void            */*cb_arg*/);
+   /*
+    * Saves the events in a ring, oldest first, by calling a function to
+    * write them. The format is a 16-byte header followed by 16 bytes per
+    * event, with all values in little-endian byte order, so it can be
+    * decoded on any machine.
+    * Returns: true if successful, otherwise false (a write failed).
+    */
+
 unsigned int GKey_get_read_size_bits(unsigned int /*history_log_2*/,
                                      size_t       /*read_offset*/);
    /*
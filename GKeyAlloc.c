@@ -0,0 +1,120 @@
+/*
+ * GKeyLib: Memory allocation
+ * Copyright (C) 2026 Christopher Bazley
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/* History:
+  CJB: 16-Oct-26: Created this source file.
+*/
+
+/* ISO library header files */
+#include <stddef.h>
+#include <stdlib.h>
+
+/* Local headers */
+#include "Internal/GKeyMisc.h"
+#include "Internal/GKeyAlloc.h"
+#include "GKey.h"
+
+/* A structure with the strictest alignment requirement of any type stored
+   in memory allocated by this library */
+typedef struct
+{
+  char c;
+  union
+  {
+    long double ld;
+    void *p;
+    unsigned long ul;
+    size_t s;
+  }
+  u;
+}
+AlignTest;
+
+enum
+{
+  Alignment = offsetof(AlignTest, u)
+};
+
+static void *std_alloc(void *arg, size_t size)
+{
+  NOT_USED(arg);
+  return malloc(size);
+}
+
+static void std_free(void *arg, void *ptr)
+{
+  NOT_USED(arg);
+  free(ptr);
+}
+
+static GKeyAllocator default_allocator = { std_alloc, std_free, NULL };
+
+void GKey_set_allocator(const GKeyAllocator *allocator)
+{
+  if (allocator == NULL)
+  {
+    DEBUGF("GKey: Restoring standard allocator\n");
+    default_allocator.alloc = std_alloc;
+    default_allocator.free = std_free;
+    default_allocator.arg = NULL;
+  }
+  else
+  {
+    DEBUGF("GKey: Setting allocator with arg %p\n", allocator->arg);
+    assert(allocator->alloc != NULL);
+    assert(allocator->free != NULL);
+    default_allocator = *allocator;
+  }
+}
+
+void GKey_get_allocator(GKeyAllocator       *out,
+                        const GKeyAllocator *allocator)
+{
+  assert(out != NULL);
+  *out = allocator != NULL ? *allocator : default_allocator;
+}
+
+void *GKey_alloc(const GKeyAllocator *allocator, size_t size)
+{
+  void *ptr;
+
+  if (allocator == NULL)
+    allocator = &default_allocator;
+
+  ptr = allocator->alloc(allocator->arg, size);
+  DEBUG_VERBOSEF("GKey: Allocated %zu bytes at %p\n", size, ptr);
+  return ptr;
+}
+
+size_t GKey_align_size(size_t size)
+{
+  return (size + Alignment - 1) / Alignment * Alignment;
+}
+
+void GKey_free(const GKeyAllocator *allocator, void *ptr)
+{
+  if (ptr == NULL)
+    return;
+
+  if (allocator == NULL)
+    allocator = &default_allocator;
+
+  DEBUG_VERBOSEF("GKey: Freeing %p\n", ptr);
+  allocator->free(allocator->arg, ptr);
+}
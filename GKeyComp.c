@@ -39,6 +39,45 @@
   CJB: 15-May-16: Fixed a null pointer dereference in gkeycomp_destroy.
   CJB: 21-Jan-18: Made debugging output even less verbose.
   CJB: 29-Nov-20: Fixed position of linefeed in verbose debugging output.
+  CJB: 16-Oct-26: Added find_sequence_bits, which uses a bit-parallel index
+                  of the ring buffer to find the longest matching sequence at
+                  all offsets at once when the history is small.
+                  find_sequence now uses RingBuffer_match to extend a
+                  sequence instead of reading one byte at a time.
+                  Added find_run, which recognises runs of the same byte
+                  that fills the ring buffer without searching it.
+                  Added an adaptive mode which emits literals without
+                  searching after a long series of unmatched bytes.
+                  Added a bounded mode which limits the work done by
+                  find_sequence for each sequence.
+                  Added find_sequence_hash, which uses hash chains to find
+                  matching sequences when the history is large.
+                  Added gkeycomp_make_with_allocator.
+                  Added gkeycomp_state_size and gkeycomp_init_in. The ring
+                  buffer, index and hash chains are now allocated in the
+                  same block of memory as the compressor.
+                  Added functions to get compressors from a pool.
+                  Added gkeycomp_make_shared, which creates a compressor that
+                  borrows its index or hash chains from a pool only while
+                  compressing.
+                  Added gkeycomp_stream and gkeycomp_compress_vec.
+                  Added gkeycomp_set_staging, which enables batching of
+                  small inputs before searching them.
+                  Added gkeycomp_set_progress, which allows progress to be
+                  reported less often and cancellation via a flag.
+                  Added a deadline mode which varies the effort spent
+                  searching to keep to a schedule set by
+                  gkeycomp_set_deadline.
+                  Added gkeycomp_set_verify, which enables decompression
+                  of the output as it is produced to check it.
+                  Added gkeycomp_set_stats, which enables collection of
+                  statistics about the work done by the compressor.
+                  Added gkeycomp_set_trace, which enables recording of
+                  events such as state changes and token decisions.
+                  Added static tracepoints, which are enabled by defining
+                  GKEY_USDT.
+                  Added gkeycomp_set_clock, which allows time to be measured
+                  by a function other than clock.
 */
 
 /* ISO library header files */
@@ -49,12 +88,22 @@
 #include <limits.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <signal.h>
+#include <time.h>
 
 /* Local headers */
 #include "Internal/GKeyMisc.h"
+#include "Internal/GKeyAlloc.h"
+#include "Internal/GKeyPool.h"
+#include "Internal/GKeyStream.h"
+#include "Internal/GKeyTrace.h"
+#include "Internal/GKeyProbes.h"
 #include "Internal/RingBuffer.h"
+#include "Internal/RingIndex.h"
+#include "Internal/RingHash.h"
 #include "GKey.h"
 #include "GKeyComp.h"
+#include "GKeyDecomp.h"
 
 /* Undefine this macro to allow the most recently compressed byte to be copied
    unless the start offset is 0 [sequence size would need to be 1 << n, but
@@ -69,10 +118,47 @@
 enum
 {
   ULongMinBit    = 32, /* Minimum no. of bits in type 'unsigned long'. */
-  MaxHistoryLog2 = ULongMinBit - CHAR_BIT /* Maximum no. of bytes to look
-                                             behind, as a base 2 logarithm. */
+  MaxHistoryLog2 = ULongMinBit - CHAR_BIT, /* Maximum no. of bytes to look
+                                              behind, as a base 2 logarithm. */
+  MissLimit      = 64, /* No. of consecutive literal bytes output before
+                          GKeyCompMode_Adaptive stops searching */
+  ProbeInterval  = 16, /* No. of literal bytes output between searches
+                          when GKeyCompMode_Adaptive isn't searching */
+  BoundedHistory = 4096, /* No. of most recently compressed bytes searched
+                            by GKeyCompMode_Bounded */
+  MaxCandidates  = 256,  /* Maximum no. of possible start positions for a
+                            sequence compared by GKeyCompMode_Bounded */
+  NiceReadSize   = 128,  /* Sequence size at which GKeyCompMode_Bounded stops
+                            looking for a longer sequence */
+  HashMinSizeLog2 = 16,  /* Smallest history searched using hash chains, as
+                            a base 2 logarithm */
+  MaxChainDepth  = 4096, /* Maximum no. of sequences compared by
+                            find_sequence_hash */
+  BoundedChainDepth = 32, /* Ditto, by GKeyCompMode_Bounded */
+  DeadlineInterval = 1024, /* No. of bytes consumed between checks of the
+                              schedule by GKeyCompMode_Deadline */
+  AheadPercent   = 95,   /* Percentage of the expected time at which
+                            GKeyCompMode_Deadline makes more effort */
+  VerifyBufferSize = 16, /* Maximum no. of output bytes waiting to be
+                            verified (enough for any one command) */
+  VerifyChunkSize = 256, /* No. of bytes decompressed at a time when
+                            verifying the output */
+  SearchTimingInterval = 128, /* No. of searches between measurements of
+                                the time taken by one (to estimate the
+                                total) */
+  ClockCalibrations = 1024 /* No. of times the clock is read to estimate the
+                            cost of reading it */
 };
 
+/* Levels of effort between which GKeyCompMode_Deadline switches */
+typedef enum
+{
+  GKeyCompEffort_Best,    /* As GKeyCompMode_Best */
+  GKeyCompEffort_Bounded, /* As GKeyCompMode_Bounded */
+  GKeyCompEffort_Runs     /* Only look for runs of the same byte */
+}
+GKeyCompEffort;
+
 /* All possible states of a compressor. The initial state must be zero. */
 typedef enum
 {
@@ -87,6 +173,8 @@ typedef enum
 }
 GKeyCompState;
 
+typedef struct GKeyCompScratch GKeyCompScratch;
+
 struct GKeyComp
 {
   GKeyCompState state;  /* Next action to do */
@@ -99,11 +187,74 @@ struct GKeyComp
   size_t read_offset;      /* Offset from write position at which to start
                               copying data */
   size_t read_size;        /* No. of bytes to be copied */
+  size_t run_start;        /* Offset from write position of the start of
+                              the run of bytes equal to 'run_byte' */
+  size_t misses;           /* No. of consecutive bytes output as literals */
+  size_t candidates;       /* No. of possible start positions for the current
+                              sequence compared so far */
   unsigned long acc;   /* Accumulator for bits waiting to be written to the
                           output buffer */
   char acc_nbits;      /* No. of bits valid in the accumulator */
+  unsigned char run_byte; /* Value of the most recently compressed byte */
+  bool extending;      /* Stalled while extending a sequence found by
+                          find_sequence_hash */
+  GKeyCompScratch *scratch; /* Scratch last borrowed from 'scratch_pool',
+                               or NULL if none since the last reset */
+  unsigned long scratch_uses; /* Value of scratch->uses when last borrowed */
+  size_t stage_count;  /* No. of bytes in the staging buffer */
+  size_t stage_pos;    /* No. of bytes in the staging buffer consumed */
+  size_t progress_due; /* Sum of 'in_total' and 'out_total' at which to
+                          report progress next */
+  GKeyCompEffort effort; /* Effort made by GKeyCompMode_Deadline */
+  bool started;        /* Whether 'start_time' is valid */
+  clock_t start_time;  /* Clock time when compression started */
+  double lag;          /* Fraction of the allowed time used minus fraction
+                          of the expected input consumed, when the schedule
+                          was last checked */
+  size_t schedule_due; /* Value of 'in_total' at which to check the
+                          schedule next */
+  size_t verified;     /* No. of bytes of input reproduced by 'verifier' */
+  bool verify_failed;  /* Output didn't reproduce the input */
+  unsigned char verify_count; /* No. of bytes in 'verify_buf' */
+  unsigned char verify_buf[VerifyBufferSize]; /* Output bytes waiting to be
+                                                 verified */
   char history_log_2;  /* Size of ring buffer as a base 2 logarithm */
+  GKeyCompMode mode;   /* Strategy for finding matching sequences */
+  GKeyAllocator allocator; /* Used to free memory, or all null if the
+                              memory belongs to the client */
   RingBuffer *history; /* Ring buffer containing recently compressed data */
+  RingIndex *index;    /* Index of the ring buffer, or NULL if too big */
+  RingHash *hash;      /* Hash chains for the ring buffer, or NULL if small */
+  GKeyPool *scratch_pool; /* Pool from which to borrow the index or hash
+                             chains, or NULL if owned by the compressor */
+  unsigned char *stage; /* Buffer in which to collect small inputs, or NULL
+                           if not staging */
+  size_t stage_size;    /* Size of the staging buffer */
+  size_t progress_interval; /* Minimum no. of bytes consumed or output
+                               between reports of progress */
+  volatile sig_atomic_t *cancel; /* Flag to be checked whenever progress is
+                                    due, or NULL if none */
+  size_t deadline_size;  /* No. of bytes expected by GKeyCompMode_Deadline */
+  clock_t deadline_ticks; /* Clock time allowed for 'deadline_size' */
+  GKeyCompClockFn *clock_fn; /* Function to read the clock, or NULL to
+                                use clock() */
+  void *clock_arg;      /* Argument for 'clock_fn' */
+  GKeyDecomp *verifier; /* Used to decompress output to verify it, or NULL */
+  RingBuffer *verify_in; /* Input not yet verified (at least), or NULL */
+  GKeyCompStats *stats; /* Statistics to be updated, or NULL */
+  double clock_cost;    /* Clock time taken to read the clock */
+  double search_time;   /* Unrounded value of stats->search_ticks */
+  GKeyTrace *trace;     /* Ring in which to record events, or NULL */
+};
+
+/* Index or hash chains that can be shared between compressors */
+struct GKeyCompScratch
+{
+  const GKeyComp *owner;   /* Compressor that last borrowed the scratch */
+  unsigned long uses;      /* No. of times the scratch has been borrowed */
+  GKeyAllocator allocator; /* Used to free memory */
+  RingIndex *index;        /* Index, or NULL if not used */
+  RingHash *hash;          /* Hash chains, or NULL if not used */
 };
 
 typedef struct
@@ -184,6 +335,13 @@ static bool write_bits(GKeyComp *comp, GKeyParameters *params, unsigned int nbit
     DEBUG_VERBOSEF("GKeyComp: Wrote byte %zu (0x%02lx) to bitstream\n",
                    out_total, old_acc & UCHAR_MAX);
     ++out_total;
+
+    if (comp->verifier != NULL)
+    {
+      /* Keep a copy to be verified at the end of the command */
+      assert(comp->verify_count < sizeof(comp->verify_buf));
+      comp->verify_buf[comp->verify_count++] = (unsigned char)old_acc;
+    }
   }
 
   if (success)
@@ -234,11 +392,413 @@ static size_t ring_writer(void *arg, const void *src, size_t n)
   return nout;
 }
 
+static void consume(GKeyComp *comp, GKeyParameters *params, size_t n)
+{
+  const unsigned char * const in_buffer = params->in_buffer;
+
+  assert(comp != NULL);
+  assert(params != NULL);
+  assert(params->in_size >= n);
+
+  /* Keep a copy of the input to compare with the verifier's output */
+  if (comp->verify_in != NULL)
+    RingBuffer_write(comp->verify_in, in_buffer, n);
+
+  comp->in_total += n;
+  params->in_buffer = in_buffer + n;
+  params->in_size -= n;
+}
+
+static bool verify_output(GKeyComp *comp)
+{
+  unsigned char out[VerifyChunkSize];
+  GKeyParameters params;
+  GKeyStatus status = GKeyStatus_OK;
+
+  assert(comp != NULL);
+  assert(comp->verifier != NULL);
+
+  params.in_buffer = comp->verify_buf;
+  params.in_size = comp->verify_count;
+  params.prog_cb = NULL;
+  params.cb_arg = NULL;
+
+  /* The verifier may still have data to copy after consuming all of its
+     input */
+  while (!comp->verify_failed &&
+         (params.in_size > 0 || status == GKeyStatus_BufferOverflow))
+  {
+    size_t n, lag;
+
+    params.out_buffer = out;
+    params.out_size = sizeof(out);
+    status = gkeydecomp_decompress(comp->verifier, &params);
+
+    /* Everything output by the verifier must match input that was
+       consumed recently enough to still be in 'verify_in' */
+    n = sizeof(out) - params.out_size;
+    lag = comp->in_total - comp->verified;
+    if ((status != GKeyStatus_OK && status != GKeyStatus_TruncatedInput &&
+         status != GKeyStatus_BufferOverflow) ||
+        n > lag || lag > comp->verify_in->size ||
+        RingBuffer_match(comp->verify_in, comp->verify_in->size - lag,
+                         out, n) != n)
+    {
+      DEBUGF("GKeyComp: Verification failed at %zu (%s)\n",
+             comp->verified, GKey_get_status_str(status));
+      comp->verify_failed = true;
+    }
+    else
+    {
+      comp->verified += n;
+    }
+  }
+
+  comp->verify_count = 0;
+  return !comp->verify_failed;
+}
+
+static void count_compared(GKeyComp *comp, size_t matched, size_t to_match)
+{
+  /* The first mismatching byte (if any) was also examined */
+  if (comp->stats != NULL)
+    comp->stats->compare_bytes += matched < to_match ? matched + 1 : matched;
+}
+
+static void update_run(GKeyComp *comp, size_t n)
+{
+  const RingBuffer *history;
+  size_t same;
+  int last;
+
+  assert(comp != NULL);
+  if (n == 0)
+    return;
+
+  /* Check whether all of the 'n' bytes just written are equal. If not, then
+     only the last is treated as the start of a new run, which is cheaper
+     than finding where it really started and merely delays the fast path
+     by one sequence. */
+  history = comp->history;
+  last = RingBuffer_read_char(history, history->size - 1);
+  if (n > 1 && RingBuffer_mismatch(history, history->size - n,
+                                   history->size - n + 1, n - 1) < n - 1)
+    same = 1;
+  else
+    same = n;
+
+  if (same == n && last == comp->run_byte)
+  {
+    /* The existing run was extended (and may now fill the buffer) */
+    comp->run_start = comp->run_start > n ? comp->run_start - n : 0;
+  }
+  else
+  {
+    /* A new run started */
+    comp->run_byte = (unsigned char)last;
+    comp->run_start = history->size - same;
+  }
+
+  DEBUG_VERBOSEF("GKeyComp: Run of 0x%02x starts at offset %zu\n",
+                 comp->run_byte, comp->run_start);
+}
+
+static void write_history(GKeyComp *comp, const void *s, size_t n)
+{
+  assert(comp != NULL);
+
+  if (comp->index != NULL)
+    RingIndex_remove(comp->index, comp->history, 0, n);
+
+  RingBuffer_write(comp->history, s, n);
+
+  if (comp->index != NULL)
+    RingIndex_add(comp->index, comp->history, comp->history->size - n, n);
+
+  if (comp->hash != NULL)
+    RingHash_add(comp->hash, comp->history, n);
+
+  update_run(comp, n);
+}
+
+static size_t copy_history(GKeyComp          *comp,
+                           RingBufferWriteFn *write_cb,
+                           void              *cb_arg,
+                           size_t             offset,
+                           size_t             n)
+{
+  size_t copied;
+
+  assert(comp != NULL);
+
+  /* If the ring buffer holds nothing but copies of one byte then copying
+     data within it changes nothing except the write position. */
+  if (comp->run_start == 0)
+  {
+    copied = RingBuffer_copy(comp->history, write_cb, cb_arg, offset, n);
+    if (comp->hash != NULL)
+      RingHash_add(comp->hash, comp->history, copied);
+
+    return copied;
+  }
+
+  if (comp->index != NULL)
+    RingIndex_remove(comp->index, comp->history, 0, n);
+
+  copied = RingBuffer_copy(comp->history, write_cb, cb_arg, offset, n);
+
+  if (comp->index != NULL)
+  {
+    /* Index the characters that were copied, then reinstate any that were
+       going to be overwritten but weren't. */
+    RingIndex_add(comp->index, comp->history,
+                  comp->history->size - copied, copied);
+    RingIndex_add(comp->index, comp->history, 0, n - copied);
+  }
+
+  if (comp->hash != NULL)
+    RingHash_add(comp->hash, comp->history, copied);
+
+  update_run(comp, copied);
+
+  return copied;
+}
+
+static bool find_run(GKeyComp *comp, GKeyParameters *params)
+{
+  const unsigned char *in_buffer;
+  size_t max_read_size, read_size;
+
+  assert(comp != NULL);
+  assert(params != NULL);
+
+  /* Only applicable at the start of a new sequence and if the ring buffer
+     is entirely filled by copies of one byte (e.g. zeros before any data
+     has been compressed). The longest matching sequence then begins at
+     offset 0, so there is no need to search. */
+  if (comp->run_start != 0 || comp->read_size != 0 ||
+      comp->read_offset != 0 || comp->best_read_size != 0)
+    return false;
+
+  max_read_size = (size_t)(1ul << comp->history_log_2) - 1;
+  in_buffer = params->in_buffer;
+
+  for (read_size = 0;
+       read_size < max_read_size && read_size < params->in_size &&
+       in_buffer[read_size] == comp->run_byte;
+       ++read_size)
+  {
+  }
+
+  if (read_size == 0)
+    return false;
+
+  /* If the run could continue beyond the end of the input data then the
+     bit-parallel search must start again, but other searches can resume
+     from the same state as if they had found the run. */
+  const bool stalled = read_size < max_read_size &&
+                       read_size == params->in_size;
+  if (stalled && comp->index != NULL)
+    return false;
+
+  DEBUG_VERBOSEF("GKeyComp: Found run of %zu bytes of 0x%02x (%s)\n",
+                 read_size, comp->run_byte, stalled ? "stalled" : "final");
+
+  consume(comp, params, read_size);
+
+  comp->read_offset = 0;
+  comp->read_size = read_size;
+  comp->max_read_size = max_read_size;
+  comp->extending = stalled && comp->hash != NULL;
+
+  /* Having run out of input, the search called next stalls immediately */
+  return !stalled;
+}
+
+static bool use_index(unsigned int history_log_2)
+{
+#ifdef FOURTH_DIMENSION
+  /* The index assumes that sequences may include any byte except the
+     most recently compressed. */
+  return history_log_2 <= RingIndexMaxSizeLog2;
+#else /* FOURTH_DIMENSION */
+  NOT_USED(history_log_2);
+  return false;
+#endif /* FOURTH_DIMENSION */
+}
+
+static bool use_hash(unsigned int history_log_2)
+{
+#ifdef FOURTH_DIMENSION
+  /* Likewise, the hash chains are only used to find sequences which
+     don't include the most recently compressed byte. */
+  return history_log_2 >= HashMinSizeLog2;
+#else /* FOURTH_DIMENSION */
+  NOT_USED(history_log_2);
+  return false;
+#endif /* FOURTH_DIMENSION */
+}
+
+static bool is_fast(const GKeyComp *comp)
+{
+  assert(comp != NULL);
+  return comp->mode == GKeyCompMode_Bounded ||
+         (comp->mode == GKeyCompMode_Deadline &&
+          comp->effort != GKeyCompEffort_Best);
+}
+
+static bool is_bounded(const GKeyComp *comp)
+{
+  assert(comp != NULL);
+
+  /* find_sequence is only used for large histories if there is too little
+     input to use the hash chains, or no hash chains could be borrowed, and
+     it mustn't search the whole history even then. */
+  return is_fast(comp) || use_hash(comp->history_log_2);
+}
+
+static clock_t read_clock(const GKeyComp *comp)
+{
+  assert(comp != NULL);
+  return comp->clock_fn != NULL ? comp->clock_fn(comp->clock_arg) : clock();
+}
+
+static void check_schedule(GKeyComp *comp)
+{
+  const clock_t now = read_clock(comp);
+  double elapsed;
+
+  assert(comp != NULL);
+  assert(comp->mode == GKeyCompMode_Deadline);
+
+  comp->schedule_due = comp->in_total + DeadlineInterval;
+  if (now == (clock_t)-1)
+    return; /* time is unavailable */
+
+  if (!comp->started)
+  {
+    comp->start_time = now;
+    comp->started = true;
+    return;
+  }
+
+  elapsed = (double)(now - comp->start_time);
+  if (comp->in_total >= comp->deadline_size ||
+      elapsed >= (double)comp->deadline_ticks)
+  {
+    /* Too late to do anything but finish as quickly as possible */
+    comp->effort = GKeyCompEffort_Runs;
+  }
+  else
+  {
+    /* Compare the fraction of the time used with the fraction of the
+       input consumed. Only change the effort if the current effort isn't
+       already bringing them closer together, because it takes time to
+       catch up. */
+    const double time_used = elapsed / (double)comp->deadline_ticks,
+                 in_used = (double)comp->in_total /
+                           (double)comp->deadline_size,
+                 lag = time_used - in_used;
+
+    if (lag > 0 && lag >= comp->lag)
+    {
+      if (comp->effort < GKeyCompEffort_Runs)
+        ++comp->effort;
+    }
+    else if (time_used * 100 < in_used * AheadPercent && lag <= comp->lag)
+    {
+      if (comp->effort > GKeyCompEffort_Best)
+        --comp->effort;
+    }
+    comp->lag = lag;
+  }
+
+  DEBUG_VERBOSEF("GKeyComp: Effort %d after %zu bytes in %.0f ticks\n",
+                 (int)comp->effort, comp->in_total, elapsed);
+}
+
+static bool skip_search(GKeyComp *comp, const GKeyParameters *params)
+{
+  assert(comp != NULL);
+  assert(params != NULL);
+
+  /* Only applicable at the start of a new sequence */
+  if (params->in_size == 0 || comp->read_size != 0 ||
+      comp->read_offset != 0 || comp->best_read_size != 0)
+    return false;
+
+  if (comp->mode == GKeyCompMode_Deadline)
+    return comp->effort == GKeyCompEffort_Runs;
+
+  /* Otherwise only applicable after many consecutive literals. Probe
+     periodically so that compressible data following a random or
+     already-compressed region is still found. */
+  if (comp->mode != GKeyCompMode_Adaptive ||
+      comp->misses < MissLimit || comp->misses % ProbeInterval == 0)
+    return false;
+
+  DEBUG_VERBOSEF("GKeyComp: Not searching after %zu misses\n", comp->misses);
+  return true;
+}
+
+static bool find_sequence_bits(GKeyComp *comp, GKeyParameters *params)
+{
+  bool success = false;
+  size_t read_size, consumed;
+  const unsigned char *in_buffer;
+
+  DEBUG_VERBOSEF("GKeyComp: Searching for match in indexed history\n");
+  assert(comp != NULL);
+  assert(params != NULL);
+  assert(comp->index != NULL);
+
+  in_buffer = params->in_buffer;
+  read_size = comp->read_size;
+
+  /* Extend all sequences matching the input data at once, until none can
+     be extended any further. Because the index tracks every candidate
+     sequence, there is no need to revisit input that has been consumed. */
+  for (consumed = 0; ; ++consumed, ++read_size)
+  {
+    if (consumed >= params->in_size)
+    {
+      DEBUG_VERBOSEF("GKeyComp: Out of input data (consumed %zu of %zu)\n",
+                     consumed, params->in_size);
+      break; /* No more data in input buffer */
+    }
+
+    if (!RingIndex_match_next(comp->index, comp->history, read_size,
+                              in_buffer[consumed]))
+    {
+      success = true;
+      break; /* No sequence matches the next byte of input */
+    }
+
+    DEBUG_VERBOSEF("GKeyComp: Consuming input byte 0x%02x at %zu\n",
+                   in_buffer[consumed], comp->in_total + consumed);
+  }
+
+  consume(comp, params, consumed);
+
+  /* The same sequence is chosen as by find_sequence: the longest, or the
+     oldest of those with equal length. */
+  comp->read_size = read_size;
+  comp->read_offset = read_size > 0 ?
+                      RingIndex_match_offset(comp->index, comp->history,
+                                             read_size) : 0;
+
+  DEBUG_VERBOSEF("GKeyComp: Found sequence %zu..%zu (%s)\n",
+                 comp->read_offset, comp->read_offset + comp->read_size - 1,
+                 success ? "final" : "stalled");
+
+  return success;
+}
+
 static bool find_sequence(GKeyComp *comp, GKeyParameters *params)
 {
   bool success;
   size_t read_offset, read_size, max_read_size, best_read_size, consumed, old_read_offset;
-  int old_byte, new_byte;
+  int new_byte;
 
   DEBUG_VERBOSEF("GKeyComp: Searching for match in recent history\n");
   assert(comp != NULL);
@@ -249,6 +809,18 @@ static bool find_sequence(GKeyComp *comp, GKeyParameters *params)
   max_read_size = comp->max_read_size;
   best_read_size = comp->best_read_size;
 
+  if (is_bounded(comp) && read_offset == 0 &&
+      read_size == 0 && best_read_size == 0 && comp->run_start != 0)
+  {
+    /* Only search the most recently compressed data, which is most likely
+       to match. This bounds the cost of searching for the first character.
+       Not needed if the ring buffer is filled by a run because the first
+       candidate is then the best (as found by find_run). */
+    const size_t size = (size_t)1 << comp->history_log_2;
+    if (size > BoundedHistory)
+      read_offset = size - BoundedHistory;
+  }
+
   /* Search the ring buffer for sequences matching the input data. */
   for (consumed = 0; ; ++read_offset, read_size = 0)
   {
@@ -300,6 +872,12 @@ static bool find_sequence(GKeyComp *comp, GKeyParameters *params)
                                          max_read_size - best_read_size,
                                          new_byte);
       assert(read_offset >= old_read_offset);
+      if (comp->stats != NULL)
+      {
+        comp->stats->find_char_bytes += read_offset == SIZE_MAX ?
+                                        max_read_size - best_read_size :
+                                        read_offset - old_read_offset + 1;
+      }
       if (read_offset == SIZE_MAX)
       {
         DEBUG_VERBOSEF("GKeyComp: First character of sequence not found\n");
@@ -307,6 +885,17 @@ static bool find_sequence(GKeyComp *comp, GKeyParameters *params)
         break;
       }
 
+      if (is_bounded(comp) && ++comp->candidates > MaxCandidates)
+      {
+        /* Settle for the longest sequence found so far (which can't be empty
+           because the first candidate always matches at least one byte). */
+        DEBUG_VERBOSEF("GKeyComp: Compared %zu candidates\n",
+                       comp->candidates - 1);
+        assert(best_read_size > 0);
+        max_read_size = best_read_size;
+        break;
+      }
+
       if (read_size++ >= best_read_size)
       {
         DEBUG_VERBOSEF("GKeyComp: Consuming input byte 0x%02x at %zu\n",
@@ -345,10 +934,28 @@ static bool find_sequence(GKeyComp *comp, GKeyParameters *params)
       /* Try to match the rest of the previous longest matching sequence */
       if (read_size < best_read_size)
       {
-        if (RingBuffer_compare(comp->history,
-                               read_offset + read_size,
-                               comp->best_read_offset + read_size,
-                               best_read_size - read_size) != 0)
+        const size_t to_match = best_read_size - read_size;
+        bool differ;
+
+        if (comp->stats != NULL)
+        {
+          /* Only statistics need the no. of bytes compared: memcmp is
+             faster at finding whether there is any difference */
+          const size_t matched =
+            RingBuffer_mismatch(comp->history, read_offset + read_size,
+                                comp->best_read_offset + read_size, to_match);
+          count_compared(comp, matched, to_match);
+          differ = matched < to_match;
+        }
+        else
+        {
+          differ = RingBuffer_compare(comp->history,
+                                      read_offset + read_size,
+                                      comp->best_read_offset + read_size,
+                                      to_match) != 0;
+        }
+
+        if (differ)
         {
           DEBUG_VERBOSEF("GKeyComp: Mismatch between previous best sequence at "
                         "%zu and new sequence at %zu\n",
@@ -361,32 +968,32 @@ static bool find_sequence(GKeyComp *comp, GKeyParameters *params)
     }
 
     /* Try to extend the matching sequence beyond the previous longest */
-    for (; read_size < max_read_size; ++read_size)
+    if (read_size < max_read_size)
     {
-      /* Get the next byte of data to be compressed */
+      /* Compare as much of the remaining input as could be part of the
+         current sequence with the ring buffer content */
       const GKeyParameters * const p = params; /* Compiler being silly */
-      if (consumed >= p->in_size)
+      size_t matched, to_match = max_read_size - read_size;
+      if (to_match > p->in_size - consumed)
+        to_match = p->in_size - consumed;
+
+      matched = RingBuffer_match(comp->history,
+                                 read_offset + read_size,
+                                 (const unsigned char *)p->in_buffer + consumed,
+                                 to_match);
+      count_compared(comp, matched, to_match);
+
+      DEBUG_VERBOSEF("GKeyComp: Consuming %zu input bytes at %zu\n",
+                     matched, comp->in_total + consumed);
+      read_size += matched;
+      consumed += matched; /* consume the bytes of input */
+
+      if (matched == to_match && read_size < max_read_size)
       {
         DEBUG_VERBOSEF("GKeyComp: Out of input data (consumed %zu of %zu)\n",
                        consumed, p->in_size);
         goto finished; /* No more data in input buffer */
       }
-
-      new_byte = ((unsigned char *)p->in_buffer)[consumed];
-
-      /* Get next byte of current sequence from history ring buffer */
-      old_byte = RingBuffer_read_char(comp->history, read_offset + read_size);
-      if (new_byte != old_byte)
-      {
-        DEBUG_VERBOSEF("GKeyComp: Mismatch at %zu (0x%02x != 0x%02x)\n",
-                      read_offset + read_size,
-                      new_byte, old_byte);
-        break;
-      }
-
-      DEBUG_VERBOSEF("GKeyComp: Consuming input byte 0x%02x at %zu\n",
-                     new_byte, comp->in_total + consumed);
-      ++consumed; /* consume the byte of input */
     }
 
     /* Mismatch with previously-compressed data or sequence has reached size
@@ -401,18 +1008,18 @@ static bool find_sequence(GKeyComp *comp, GKeyParameters *params)
 
       comp->best_read_offset = read_offset;
       best_read_size = read_size;
+
+      if (is_bounded(comp) && best_read_size >= NiceReadSize)
+      {
+        DEBUG_VERBOSEF("GKeyComp: Sequence is long enough\n");
+        max_read_size = best_read_size;
+        break;
+      }
     }
   }
 
 finished:
-  comp->in_total += consumed;
-
-  {
-    GKeyParameters * const p = params; /* Compiler being silly */
-    p->in_buffer = (unsigned char *)p->in_buffer + consumed;
-    assert(p->in_size >= consumed);
-    p->in_size -= consumed;
-  }
+  consume(comp, params, consumed);
 
   if (best_read_size >= max_read_size)
   {
@@ -440,76 +1047,778 @@ finished:
   return success;
 }
 
-static const char *get_state_str(GKeyCompState state)
+static bool find_sequence_hash(GKeyComp *comp, GKeyParameters *params)
 {
-#ifdef DEBUG_OUTPUT
-  static const char *strings[] =
-  {
-    "NextSequence",
-    "Progress",
-    "FindSequence",
-    "PutOffset",
-    "PutSize",
-    "PutByte",
-    "PutBytes",
-    "Flush"
-  };
-  assert(state - GKeyCompState_NextSequence >= 0);
-  assert((size_t)(state - GKeyCompState_NextSequence) < ARRAY_SIZE(strings));
-  return strings[state - GKeyCompState_NextSequence];
-#else /* DEBUG_OUTPUT */
-  NOT_USED(state);
-  return "";
-#endif /* DEBUG_OUTPUT */
-}
+  bool success;
+  size_t read_offset, read_size, max_read_size, consumed, size;
+  const unsigned char *in_buffer;
 
-GKeyComp *gkeycomp_make(unsigned int history_log_2)
-{
-  assert(history_log_2 <= MaxHistoryLog2);
-  GKeyComp *comp = malloc(sizeof(*comp));
-  if (comp != NULL)
-  {
-    memset(comp, 0, offsetof(GKeyComp, history_log_2));
-    comp->history_log_2 = history_log_2;
-    comp->history = RingBuffer_make(history_log_2);
-    if (comp->history == NULL)
-      FREE_SAFE(comp);
-  }
+  DEBUG_VERBOSEF("GKeyComp: Searching for match in hashed history\n");
+  assert(comp != NULL);
+  assert(params != NULL);
+  assert(comp->hash != NULL);
 
-  return comp;
-}
+  in_buffer = params->in_buffer;
+  size = (size_t)1 << comp->history_log_2;
 
-void gkeycomp_destroy(GKeyComp *comp)
-{
-  if (comp != NULL)
+  if (comp->extending)
   {
-    RingBuffer_destroy(comp->history);
-    free(comp);
+    /* Continue to extend the sequence found before running out of input */
+    read_offset = comp->read_offset;
+    read_size = comp->read_size;
+    max_read_size = size - read_offset - 1;
+
+    const size_t to_match = LOWEST(max_read_size - read_size,
+                                   params->in_size);
+
+    consumed = RingBuffer_match(comp->history,
+                                read_offset + read_size,
+                                in_buffer,
+                                to_match);
+    count_compared(comp, consumed, to_match);
+    read_size += consumed;
   }
-}
+  else
+  {
+    size_t depth = 0, max_depth, offset;
+
+    /* Fall back to a bounded linear search if there isn't enough input to
+       compute a hash value, and to resume such a search. */
+    if (params->in_size < RingHashMinSize || comp->read_size != 0 ||
+        comp->read_offset != 0 || comp->best_read_size != 0)
+      return find_sequence(comp, params);
+
+    max_depth = is_fast(comp) ? BoundedChainDepth : MaxChainDepth;
+    read_offset = 0;
+    read_size = 0;
+
+    /* Compare the input data with each of the sequences that have the same
+       hash value, most recent first, and keep the longest (or most recent
+       of those with equal length). */
+    for (offset = RingHash_first(comp->hash, comp->history, in_buffer);
+         offset != SIZE_MAX && depth < max_depth;
+         offset = RingHash_next(comp->hash, comp->history, offset), ++depth)
+    {
+      size_t matched;
+      const size_t to_match = LOWEST(size - offset - 1, params->in_size);
+
+      /* Skip sequences that can't be longer than the best so far, either
+         because of where they start or because they differ at the end */
+      if (to_match <= read_size ||
+          (read_size > 0 &&
+           RingBuffer_read_char(comp->history, offset + read_size) !=
+             in_buffer[read_size]))
+        continue;
+
+      matched = RingBuffer_match(comp->history, offset, in_buffer, to_match);
+      count_compared(comp, matched, to_match);
+      if (matched > read_size)
+      {
+        DEBUG_VERBOSEF("GKeyComp: Replacing best match with %zu..%zu\n",
+                       offset, offset + matched - 1);
+        read_offset = offset;
+        read_size = matched;
 
-void gkeycomp_reset(GKeyComp *comp)
-{
-  assert(comp != NULL);
-  memset(comp, 0, offsetof(GKeyComp, history_log_2));
-  RingBuffer_reset(comp->history);
-}
+        if (matched == params->in_size ||
+            (is_fast(comp) && matched >= NiceReadSize))
+          break;
+      }
+    }
 
-GKeyStatus gkeycomp_compress(GKeyComp       *comp,
-                             GKeyParameters *params)
-{
-  GKeyStatus status = GKeyStatus_OK;
+    DEBUG_VERBOSEF("GKeyComp: Compared %zu sequences\n", depth);
+
+    /* Sequences shorter than the hash are never worth copying from a large
+       ring buffer because each copy command requires more bits than are
+       needed to encode that many literal values. */
+    if (read_size < RingHashMinSize)
+    {
+      read_offset = 0;
+      read_size = 0;
+    }
+
+    max_read_size = size - read_offset - 1;
+    consumed = read_size;
+  }
+
+  DEBUG_VERBOSEF("GKeyComp: Consuming %zu input bytes at %zu\n",
+                 consumed, comp->in_total);
+  consume(comp, params, consumed);
+
+  /* If all of the input data matched then the sequence might be longer */
+  success = read_size == 0 || read_size >= max_read_size ||
+            params->in_size > 0;
+
+  comp->read_offset = read_offset;
+  comp->read_size = read_size;
+  comp->extending = !success;
+
+  DEBUG_VERBOSEF("GKeyComp: Found sequence %zu..%zu (%s)\n",
+                 comp->read_offset, comp->read_offset + comp->read_size - 1,
+                 success ? "final" : "stalled");
+
+  return success;
+}
+
+static bool search(GKeyComp *comp, GKeyParameters *params)
+{
+  return find_run(comp, params) || skip_search(comp, params) ||
+         (comp->index != NULL ? find_sequence_bits(comp, params) :
+          comp->hash != NULL ? find_sequence_hash(comp, params) :
+          find_sequence(comp, params));
+}
+
+static bool search_with_stats(GKeyComp *comp, GKeyParameters *params)
+{
+  GKeyCompStats * const stats = comp->stats;
+  bool found;
+
+  assert(stats != NULL);
+
+  /* Reading the clock costs more than many searches, so only time a
+     sample of them and scale up the result */
+  if (stats->searches++ % SearchTimingInterval == 0)
+  {
+    const clock_t start = read_clock(comp);
+    found = search(comp, params);
+    comp->search_time += ((double)(read_clock(comp) - start) -
+                          comp->clock_cost) *
+                         SearchTimingInterval;
+    stats->search_ticks = comp->search_time > 0 ?
+                          (clock_t)comp->search_time : 0;
+  }
+  else
+  {
+    found = search(comp, params);
+  }
+
+  if (!found)
+    ++stats->stalls;
+
+  return found;
+}
+
+static void count_copy(GKeyComp *comp, unsigned int nbits)
+{
+  GKeyCompStats * const stats = comp->stats;
+  size_t bin = 0;
+
+  if (stats == NULL)
+    return;
+
+  ++stats->copies;
+  if (nbits < (unsigned int)comp->history_log_2)
+    ++stats->short_sizes;
+  else
+    ++stats->full_sizes;
+
+  assert(comp->read_size > 0);
+  while ((comp->read_size >> bin) > 1 &&
+         bin < ARRAY_SIZE(stats->lengths) - 1)
+    ++bin;
+  ++stats->lengths[bin];
+}
+
+static void record_event(const GKeyComp *comp, GKeyTraceType type,
+                         GKeyCompState state, size_t arg1, size_t arg2)
+{
+  assert(comp != NULL);
+  assert(comp->trace != NULL);
+  GKeyTrace_record(comp->trace, GKeyTraceSource_Comp, type, state,
+                   comp->in_total, arg1, arg2);
+}
+
+static const char *get_state_str(GKeyCompState state)
+{
+#ifdef DEBUG_OUTPUT
+  static const char *strings[] =
+  {
+    "NextSequence",
+    "Progress",
+    "FindSequence",
+    "PutOffset",
+    "PutSize",
+    "PutByte",
+    "PutBytes",
+    "Flush"
+  };
+  assert(state - GKeyCompState_NextSequence >= 0);
+  assert((size_t)(state - GKeyCompState_NextSequence) < ARRAY_SIZE(strings));
+  return strings[state - GKeyCompState_NextSequence];
+#else /* DEBUG_OUTPUT */
+  NOT_USED(state);
+  return "";
+#endif /* DEBUG_OUTPUT */
+}
+
+static size_t get_finder_size(unsigned int history_log_2)
+{
+  size_t size = 0;
+
+  if (use_index(history_log_2))
+    size = RingIndex_state_size(history_log_2);
+  else if (use_hash(history_log_2))
+    size = RingHash_state_size(history_log_2);
+
+  return size;
+}
+
+static void init_finder(RingIndex   **index,
+                        RingHash    **hash,
+                        char         *buffer,
+                        unsigned int  history_log_2)
+{
+  *index = NULL;
+  *hash = NULL;
+  if (use_index(history_log_2))
+  {
+    *index = (RingIndex *)buffer;
+    RingIndex_init(*index, history_log_2);
+  }
+  else if (use_hash(history_log_2))
+  {
+    *hash = (RingHash *)buffer;
+    RingHash_init(*hash, history_log_2);
+  }
+}
+
+static size_t get_state_size(unsigned int history_log_2, bool own_finder)
+{
+  size_t size;
+
+  assert(history_log_2 <= MaxHistoryLog2);
+  size = GKey_align_size(sizeof(GKeyComp)) +
+         GKey_align_size(RingBuffer_state_size(history_log_2));
+
+  if (own_finder)
+    size += get_finder_size(history_log_2);
+
+  return size;
+}
+
+static GKeyComp *init_in(void         *buffer,
+                         size_t        size,
+                         unsigned int  history_log_2,
+                         bool          own_finder)
+{
+  GKeyComp *comp = NULL;
+
+  assert(buffer != NULL || size == 0);
+  if (size >= get_state_size(history_log_2, own_finder))
+  {
+    /* The ring buffer immediately follows the compressor, and is followed
+       by the index or hash chains (if any) */
+    char *next = (char *)buffer + GKey_align_size(sizeof(*comp));
+
+    comp = buffer;
+    memset(comp, 0, offsetof(GKeyComp, history_log_2));
+    comp->history_log_2 = history_log_2;
+    comp->mode = GKeyCompMode_Best;
+    comp->allocator.alloc = NULL;
+    comp->allocator.free = NULL;
+    comp->allocator.arg = NULL;
+
+    comp->history = (RingBuffer *)next;
+    RingBuffer_init(comp->history, history_log_2);
+    next += GKey_align_size(RingBuffer_state_size(history_log_2));
+
+    comp->scratch_pool = NULL;
+    comp->stage = NULL;
+    comp->stage_size = 0;
+    comp->progress_interval = 0;
+    comp->cancel = NULL;
+    comp->deadline_size = 0;
+    comp->deadline_ticks = 0;
+    comp->clock_fn = NULL;
+    comp->clock_arg = NULL;
+    comp->verifier = NULL;
+    comp->verify_in = NULL;
+    comp->stats = NULL;
+    comp->trace = NULL;
+    if (own_finder)
+    {
+      init_finder(&comp->index, &comp->hash, next, history_log_2);
+    }
+    else
+    {
+      /* The index or hash chains will be borrowed while compressing */
+      comp->index = NULL;
+      comp->hash = NULL;
+    }
+  }
+  else
+  {
+    DEBUGF("GKeyComp: %zu bytes is too small for history %u\n",
+           size, history_log_2);
+  }
+
+  return comp;
+}
+
+static GKeyComp *make(unsigned int         history_log_2,
+                      GKeyPool            *scratch_pool,
+                      const GKeyAllocator *allocator)
+{
+  const bool own_finder = (scratch_pool == NULL);
+  const size_t size = get_state_size(history_log_2, own_finder);
+  void * const buffer = GKey_alloc(allocator, size);
+  GKeyComp *comp = NULL;
+
+  if (buffer != NULL)
+  {
+    comp = init_in(buffer, size, history_log_2, own_finder);
+    assert(comp != NULL);
+    GKey_get_allocator(&comp->allocator, allocator);
+    comp->scratch_pool = scratch_pool;
+  }
+
+  return comp;
+}
+
+GKeyComp *gkeycomp_make(unsigned int history_log_2)
+{
+  return gkeycomp_make_with_allocator(history_log_2, NULL);
+}
+
+GKeyComp *gkeycomp_make_with_allocator(unsigned int         history_log_2,
+                                       const GKeyAllocator *allocator)
+{
+  return make(history_log_2, NULL, allocator);
+}
+
+GKeyComp *gkeycomp_make_shared(unsigned int         history_log_2,
+                               GKeyPool            *scratch_pool,
+                               const GKeyAllocator *allocator)
+{
+  assert(scratch_pool != NULL);
+  return make(history_log_2, scratch_pool, allocator);
+}
+
+size_t gkeycomp_state_size(unsigned int history_log_2)
+{
+  return get_state_size(history_log_2, true);
+}
+
+GKeyComp *gkeycomp_init_in(void         *buffer,
+                           size_t        size,
+                           unsigned int  history_log_2)
+{
+  return init_in(buffer, size, history_log_2, true);
+}
+
+void gkeycomp_destroy(GKeyComp *comp)
+{
+  if (comp != NULL && comp->allocator.free != NULL)
+  {
+    /* Copy the allocator because it is part of the object to be freed */
+    const GKeyAllocator allocator = comp->allocator;
+    GKey_free(&allocator, comp->stage);
+    gkeydecomp_destroy(comp->verifier);
+    RingBuffer_destroy(comp->verify_in, &allocator);
+    GKey_free(&allocator, comp);
+  }
+}
+
+void gkeycomp_reset(GKeyComp *comp)
+{
+  assert(comp != NULL);
+  memset(comp, 0, offsetof(GKeyComp, history_log_2));
+  RingBuffer_reset(comp->history);
+  if (comp->index != NULL)
+    RingIndex_reset(comp->index);
+  if (comp->hash != NULL)
+    RingHash_reset(comp->hash);
+  if (comp->verifier != NULL)
+  {
+    gkeydecomp_reset(comp->verifier);
+    RingBuffer_reset(comp->verify_in);
+  }
+}
+
+static void *pool_make(unsigned int         history_log_2,
+                       const GKeyAllocator *allocator)
+{
+  return gkeycomp_make_with_allocator(history_log_2, allocator);
+}
+
+static void pool_reset(void *object)
+{
+  GKeyComp * const comp = object;
+
+  /* Objects got from a pool must be as though newly created */
+  gkeycomp_reset(comp);
+  comp->mode = GKeyCompMode_Best;
+  (void)gkeycomp_set_staging(comp, 0);
+  gkeycomp_set_progress(comp, 0, NULL);
+  gkeycomp_set_deadline(comp, 0, 0);
+  gkeycomp_set_clock(comp, NULL, NULL);
+  (void)gkeycomp_set_verify(comp, false);
+  gkeycomp_set_stats(comp, NULL);
+  gkeycomp_set_trace(comp, NULL);
+}
+
+static void pool_destroy(void *object)
+{
+  gkeycomp_destroy(object);
+}
+
+static const GKeyPoolType pool_type = { pool_make, pool_reset, pool_destroy };
+
+GKeyPool *gkeycomp_pool_make(unsigned int         history_log_2,
+                             size_t               max_free,
+                             const GKeyAllocator *allocator,
+                             const GKeyPoolLock  *lock)
+{
+  assert(history_log_2 <= MaxHistoryLog2);
+  return GKeyPool_make(&pool_type, history_log_2, max_free, allocator, lock);
+}
+
+GKeyComp *gkeycomp_pool_get(GKeyPool *pool)
+{
+  return GKeyPool_get(pool, &pool_type);
+}
+
+void gkeycomp_pool_put(GKeyPool *pool, GKeyComp *comp)
+{
+  GKeyPool_put(pool, &pool_type, comp);
+}
+
+static void *scratch_make(unsigned int         history_log_2,
+                          const GKeyAllocator *allocator)
+{
+  const size_t size = GKey_align_size(sizeof(GKeyCompScratch)) +
+                      get_finder_size(history_log_2);
+  GKeyCompScratch * const scratch = GKey_alloc(allocator, size);
+
+  if (scratch != NULL)
+  {
+    scratch->owner = NULL;
+    scratch->uses = 0;
+    GKey_get_allocator(&scratch->allocator, allocator);
+    init_finder(&scratch->index, &scratch->hash,
+                (char *)scratch + GKey_align_size(sizeof(*scratch)),
+                history_log_2);
+  }
+
+  return scratch;
+}
+
+static void scratch_reset(void *object)
+{
+  /* Nothing to do because the index or hash chains are rebuilt when
+     borrowed, unless they still match the borrower's history */
+  NOT_USED(object);
+}
+
+static void scratch_destroy(void *object)
+{
+  GKeyCompScratch * const scratch = object;
+
+  if (scratch != NULL)
+  {
+    /* Copy the allocator because it is part of the object to be freed */
+    const GKeyAllocator allocator = scratch->allocator;
+    GKey_free(&allocator, scratch);
+  }
+}
+
+static const GKeyPoolType scratch_type = {
+  scratch_make, scratch_reset, scratch_destroy
+};
+
+GKeyPool *gkeycomp_scratch_pool_make(unsigned int         history_log_2,
+                                     size_t               max_free,
+                                     const GKeyAllocator *allocator,
+                                     const GKeyPoolLock  *lock)
+{
+  assert(history_log_2 <= MaxHistoryLog2);
+  return GKeyPool_make(&scratch_type, history_log_2, max_free, allocator,
+                       lock);
+}
+
+static void borrow_scratch(GKeyComp *comp)
+{
+  GKeyCompScratch *scratch;
+
+  assert(comp != NULL);
+  assert(comp->scratch_pool != NULL);
+  assert(comp->index == NULL);
+  assert(comp->hash == NULL);
+
+  if (!use_index(comp->history_log_2) && !use_hash(comp->history_log_2))
+    return; /* nothing to borrow */
+
+  /* If no scratch is available then fall back to searching the ring
+     buffer directly */
+  scratch = GKeyPool_get(comp->scratch_pool, &scratch_type);
+  if (scratch == NULL)
+  {
+    DEBUGF("GKeyComp: No scratch available\n");
+    if (comp->state == GKeyCompState_FindSequence && comp->read_size > 0)
+    {
+      /* Neither find_sequence_bits nor find_sequence_hash sets the maximum
+         size of the sequence found so far, which find_sequence needs to
+         extend it instead */
+      comp->max_read_size = comp->history->size - 1 - comp->read_offset;
+      comp->extending = false;
+    }
+    return;
+  }
+
+  /* Rebuild the index or hash chains unless nobody else has used them
+     since they were last returned by this compressor */
+  if (scratch->owner != comp || comp->scratch != scratch ||
+      comp->scratch_uses != scratch->uses)
+  {
+    const RingBuffer * const history = comp->history;
+
+    DEBUGF("GKeyComp: Rebuilding scratch %p\n", (void *)scratch);
+    if (scratch->index != NULL)
+    {
+      assert(scratch->index->size == history->size);
+      RingIndex_rebuild(scratch->index, history);
+
+      /* Restore the state of any search that was in progress by matching
+         the same sequence again */
+      if (comp->state == GKeyCompState_FindSequence)
+      {
+        for (size_t i = 0; i < comp->read_size; ++i)
+        {
+          const bool found = RingIndex_match_next(scratch->index, history, i,
+                             RingBuffer_read_char(history,
+                                                  comp->read_offset + i));
+          assert(found);
+          NOT_USED(found);
+        }
+      }
+    }
+    else if (scratch->hash != NULL)
+    {
+      assert(scratch->hash->size == history->size);
+      RingHash_rebuild(scratch->hash, history,
+                       history->filled ? history->size : history->write_pos);
+    }
+  }
+
+  scratch->owner = comp;
+  comp->scratch = scratch;
+  comp->scratch_uses = ++scratch->uses;
+  comp->index = scratch->index;
+  comp->hash = scratch->hash;
+}
+
+static void return_scratch(GKeyComp *comp)
+{
+  assert(comp != NULL);
+  assert(comp->scratch_pool != NULL);
+
+  if (comp->index != NULL || comp->hash != NULL)
+  {
+    comp->index = NULL;
+    comp->hash = NULL;
+    GKeyPool_put(comp->scratch_pool, &scratch_type, comp->scratch);
+  }
+}
+
+void gkeycomp_set_mode(GKeyComp     *comp,
+                       GKeyCompMode  mode)
+{
+  assert(comp != NULL);
+  assert(mode == GKeyCompMode_Best || mode == GKeyCompMode_Adaptive ||
+         mode == GKeyCompMode_Bounded || mode == GKeyCompMode_Deadline);
+  DEBUGF("GKeyComp: Setting mode %d\n", (int)mode);
+  comp->mode = mode;
+}
+
+void gkeycomp_set_progress(GKeyComp              *comp,
+                           size_t                 interval,
+                           volatile sig_atomic_t *cancel)
+{
+  assert(comp != NULL);
+  DEBUGF("GKeyComp: Setting progress interval %zu and cancel flag %p\n",
+         interval, (void *)cancel);
+  comp->progress_interval = interval;
+  comp->cancel = cancel;
+}
+
+static void restart_schedule(GKeyComp *comp)
+{
+  assert(comp != NULL);
+
+  /* Start again on the next call to gkeycomp_compress */
+  comp->effort = GKeyCompEffort_Best;
+  comp->started = false;
+  comp->lag = 0;
+  comp->schedule_due = comp->in_total;
+}
+
+static void calibrate_clock(GKeyComp *comp)
+{
+  clock_t start;
+
+  assert(comp != NULL);
+
+  /* Each measurement of the time taken by a search includes part of the
+     time taken to read the clock, which is often longer. */
+  start = read_clock(comp);
+  for (int i = 1; i < ClockCalibrations; ++i)
+    (void)read_clock(comp);
+  comp->clock_cost = (double)(read_clock(comp) - start) / ClockCalibrations;
+}
+
+void gkeycomp_set_deadline(GKeyComp *comp,
+                           size_t    in_size,
+                           clock_t   ticks)
+{
+  assert(comp != NULL);
+  DEBUGF("GKeyComp: Setting deadline of %.0f ticks for %zu bytes\n",
+         (double)ticks, in_size);
+  comp->deadline_size = in_size;
+  comp->deadline_ticks = ticks;
+  restart_schedule(comp);
+}
+
+void gkeycomp_set_clock(GKeyComp        *comp,
+                        GKeyCompClockFn *clock_fn,
+                        void            *arg)
+{
+  assert(comp != NULL);
+  DEBUGF("GKeyComp: Setting %s clock with arg %p\n",
+         clock_fn != NULL ? "custom" : "default", arg);
+  comp->clock_fn = clock_fn;
+  comp->clock_arg = arg;
+
+  /* Times read from different clocks can't be compared */
+  restart_schedule(comp);
+  if (comp->stats != NULL)
+    calibrate_clock(comp);
+}
+
+void gkeycomp_set_trace(GKeyComp *comp, GKeyTrace *trace)
+{
+  assert(comp != NULL);
+  DEBUGF("GKeyComp: Setting trace %p\n", (void *)trace);
+  comp->trace = trace;
+}
+
+void gkeycomp_set_stats(GKeyComp *comp, GKeyCompStats *stats)
+{
+  assert(comp != NULL);
+  DEBUGF("GKeyComp: Setting stats %p\n", (void *)stats);
+  if (stats != NULL)
+  {
+    memset(stats, 0, sizeof(*stats));
+    comp->search_time = 0;
+    calibrate_clock(comp);
+  }
+
+  comp->stats = stats;
+}
+
+bool gkeycomp_set_verify(GKeyComp *comp, bool verify)
+{
+  bool success = true;
+
+  assert(comp != NULL);
+  assert(comp->in_total == 0);
+  DEBUGF("GKeyComp: %sabling verification\n", verify ? "En" : "Dis");
+
+  if (verify == (comp->verifier != NULL))
+    return true;
+
+  if (verify)
+  {
+    /* A compressor in caller-owned memory has no allocator */
+    if (comp->allocator.alloc == NULL)
+      return false;
+
+    /* Output is verified after each command, by which time the input
+       consumed but not yet verified can be almost twice the history size
+       (the data of that command and the previous one). */
+    comp->verifier = gkeydecomp_make_with_allocator(comp->history_log_2,
+                                                    &comp->allocator);
+    comp->verify_in = RingBuffer_make(comp->history_log_2 + 1,
+                                      &comp->allocator);
+    if (comp->verifier == NULL || comp->verify_in == NULL)
+      success = false;
+  }
+
+  if (!verify || !success)
+  {
+    gkeydecomp_destroy(comp->verifier);
+    comp->verifier = NULL;
+    RingBuffer_destroy(comp->verify_in, &comp->allocator);
+    comp->verify_in = NULL;
+  }
+
+  return success;
+}
+
+bool gkeycomp_set_staging(GKeyComp *comp, size_t block_size)
+{
+  unsigned char *stage = NULL;
+
+  assert(comp != NULL);
+  assert(comp->stage_count == 0);
+  DEBUGF("GKeyComp: Setting staging block size %zu\n", block_size);
+
+  if (block_size == comp->stage_size)
+    return true;
+
+  if (block_size > 0)
+  {
+    /* A compressor in caller-owned memory has no allocator */
+    if (comp->allocator.alloc == NULL)
+      return false;
+
+    stage = GKey_alloc(&comp->allocator, block_size);
+    if (stage == NULL)
+      return false;
+  }
+
+  if (comp->stage != NULL)
+    GKey_free(&comp->allocator, comp->stage);
+
+  comp->stage = stage;
+  comp->stage_size = block_size;
+  return true;
+}
+
+static GKeyStatus compress(GKeyComp       *comp,
+                           GKeyParameters *params)
+{
+  GKeyStatus status = GKeyStatus_OK;
   GKeyCompState state;
   bool flush, input = true;
   const unsigned char *in_buffer;
   RingWriterParams rwp;
-  size_t copied;
+  size_t copied, total;
   unsigned int nbits;
+  clock_t start_time = 0;
+  GKeyCompState traced_state;
 
   assert(comp != NULL);
   assert(params != NULL);
 
-  state = comp->state;
+  state = traced_state = comp->state;
+
+  GKEY_PROBE3(compress_entry, comp, params->in_size, params->out_size);
+  if (state >= GKeyCompState_PutOffset)
+  {
+    /* Output was pending when the previous call returned */
+    GKEY_PROBE2(compress_resume, comp, (int)state);
+  }
+
+  if (comp->trace != NULL)
+  {
+    record_event(comp, GKeyTraceType_Call, state,
+                 params->in_size, params->out_size);
+  }
+
+  if (comp->stats != NULL)
+    start_time = read_clock(comp);
+
+  if (comp->scratch_pool != NULL)
+    borrow_scratch(comp);
 
   /* Treat no input as a special case that force-completes the current
      sequence then flushes any bits lingering in the accumulator. */
@@ -518,32 +1827,66 @@ GKeyStatus gkeycomp_compress(GKeyComp       *comp,
 
   do
   {
+    if (comp->trace != NULL && state != traced_state)
+    {
+      record_event(comp, GKeyTraceType_State, state, traced_state, 0);
+      traced_state = state;
+    }
+
     switch (state)
     {
       case GKeyCompState_NextSequence:
+        /* Check the output for the previous sequence before starting on the
+           next one */
+        if (comp->verifier != NULL && !verify_output(comp))
+        {
+          status = GKeyStatus_VerifyFailed;
+          break;
+        }
+
         /* Reset the compressor's state to find the next matching sequence */
         DEBUG_VERBOSEF("GKeyComp: Zeroing sequence parameters\n");
         comp->best_read_size = 0;
         comp->best_read_offset = 0;
         comp->read_size = 0;
         comp->read_offset = 0;
+        comp->candidates = 0;
+        comp->extending = false;
         /* FALLTHROUGH */
 
       case GKeyCompState_Progress:
-        DEBUG_VERBOSEF("GKeyComp: Reporting progress (%zu in, %zu out)\n",
-                       comp->in_total, comp->out_total);
+        if (comp->mode == GKeyCompMode_Deadline &&
+            comp->in_total >= comp->schedule_due)
+          check_schedule(comp);
 
-        /* Do a callback to report progress, if a function was supplied. */
-        if (params->prog_cb != NULL)
+        total = comp->in_total + comp->out_total;
+        if (total < comp->progress_due)
         {
-          if (params->prog_cb(params->cb_arg, comp->in_total, comp->out_total))
-            state = GKeyCompState_FindSequence;
-          else
-            status = GKeyStatus_Aborted;
+          /* Not enough has happened since progress was last reported */
+          state = GKeyCompState_FindSequence;
+        }
+        else if (comp->cancel != NULL && *comp->cancel != 0)
+        {
+          DEBUGF("GKeyComp: Cancelled\n");
+          status = GKeyStatus_Aborted;
         }
         else
         {
-          state = GKeyCompState_FindSequence;
+          DEBUG_VERBOSEF("GKeyComp: Reporting progress (%zu in, %zu out)\n",
+                         comp->in_total, comp->out_total);
+
+          /* Do a callback to report progress, if a function was supplied. */
+          if (params->prog_cb == NULL ||
+              params->prog_cb(params->cb_arg, comp->in_total, comp->out_total))
+          {
+            comp->progress_due = total + LOWEST(comp->progress_interval,
+                                                SIZE_MAX - total);
+            state = GKeyCompState_FindSequence;
+          }
+          else
+          {
+            status = GKeyStatus_Aborted;
+          }
         }
 
         if (state != GKeyCompState_FindSequence)
@@ -554,7 +1897,8 @@ GKeyStatus gkeycomp_compress(GKeyComp       *comp,
       case GKeyCompState_FindSequence:
         /* Read bytes from the input buffer, updating the read offset and size
            to indicate a matching sequence in the ring buffer. */
-        if (flush || find_sequence(comp, params))
+        if (flush || (comp->stats != NULL ? search_with_stats(comp, params) :
+                                            search(comp, params)))
         {
           /* Found the longest matching sequence (which may be empty). */
           if (comp->read_size == 0)
@@ -563,7 +1907,16 @@ GKeyStatus gkeycomp_compress(GKeyComp       *comp,
             if (params->in_size > 0)
             {
               /* Put the unmatched byte as a literal value */
+              ++comp->misses;
               state = GKeyCompState_PutByte;
+              GKEY_PROBE2(compress_literal, comp,
+                          *(const unsigned char *)params->in_buffer);
+              if (comp->trace != NULL)
+              {
+                record_event(comp, GKeyTraceType_Literal, state,
+                             *(const unsigned char *)params->in_buffer, 0);
+                traced_state = state;
+              }
             }
             else if (flush)
             {
@@ -585,9 +1938,31 @@ GKeyStatus gkeycomp_compress(GKeyComp       *comp,
                                             comp->read_offset);
             if (comp->read_size * (CHAR_BIT + 1) <
                   comp->history_log_2 + nbits + 1)
+            {
+              comp->misses += comp->read_size;
               state = GKeyCompState_PutBytes;
+              GKEY_PROBE3(compress_literals, comp,
+                          comp->read_offset, comp->read_size);
+              if (comp->trace != NULL)
+              {
+                record_event(comp, GKeyTraceType_Literals, state,
+                             comp->read_offset, comp->read_size);
+                traced_state = state;
+              }
+            }
             else
+            {
+              comp->misses = 0;
               state = GKeyCompState_PutOffset;
+              GKEY_PROBE3(compress_copy, comp,
+                          comp->read_offset, comp->read_size);
+              if (comp->trace != NULL)
+              {
+                record_event(comp, GKeyTraceType_Copy, state,
+                             comp->read_offset, comp->read_size);
+                traced_state = state;
+              }
+            }
           }
         }
         else
@@ -595,6 +1970,13 @@ GKeyStatus gkeycomp_compress(GKeyComp       *comp,
           /* Need to examine the next batch of input to extend the current
              match. */
           input = false;
+          GKEY_PROBE3(compress_stall, comp,
+                      comp->read_offset, comp->read_size);
+          if (comp->trace != NULL)
+          {
+            record_event(comp, GKeyTraceType_Stall, state,
+                         comp->read_offset, comp->read_size);
+          }
         }
 
         if (state != GKeyCompState_PutOffset)
@@ -626,13 +2008,15 @@ GKeyStatus gkeycomp_compress(GKeyComp       *comp,
                        nbits,
                        comp->read_size))
         {
+          count_copy(comp, nbits);
+
           /* Copy matching sequence to the write position in the ring
              buffer. */
-          copied = RingBuffer_copy(comp->history,
-                                   NULL,
-                                   NULL,
-                                   comp->read_offset,
-                                   comp->read_size);
+          copied = copy_history(comp,
+                                NULL,
+                                NULL,
+                                comp->read_offset,
+                                comp->read_size);
           assert(copied <= comp->read_size);
           state = GKeyCompState_NextSequence;
         }
@@ -653,14 +2037,14 @@ GKeyStatus gkeycomp_compress(GKeyComp       *comp,
                        (unsigned long)*in_buffer << 1))
         {
           /* Write unmatched byte into the ring buffer */
-          RingBuffer_write(comp->history, params->in_buffer, 1);
+          write_history(comp, params->in_buffer, 1);
 
           /* Consume the unmatched byte */
           DEBUG_VERBOSEF("GKeyComp: Consuming input byte 0x%02x at %zu\n",
                          *in_buffer, comp->in_total);
-          params->in_buffer = in_buffer + 1;
-          --params->in_size;
-          ++comp->in_total;
+          consume(comp, params, 1);
+          if (comp->stats != NULL)
+            ++comp->stats->literals;
 
           state = GKeyCompState_NextSequence;
         }
@@ -674,12 +2058,15 @@ GKeyStatus gkeycomp_compress(GKeyComp       *comp,
         DEBUG_VERBOSEF("GKeyComp: Putting sequence as literal values\n");
         rwp.comp = comp;
         rwp.params = params;
-        copied = RingBuffer_copy(comp->history,
-                                 ring_writer,
-                                 &rwp,
-                                 comp->read_offset,
-                                 comp->read_size);
+        copied = copy_history(comp,
+                              ring_writer,
+                              &rwp,
+                              comp->read_offset,
+                              comp->read_size);
         assert(copied <= comp->read_size);
+        if (comp->stats != NULL)
+          comp->stats->literals += copied;
+
         if (copied >= comp->read_size)
         {
           state = GKeyCompState_NextSequence;
@@ -696,10 +2083,13 @@ GKeyStatus gkeycomp_compress(GKeyComp       *comp,
 
       case GKeyCompState_Flush:
         DEBUG_VERBOSEF("GKeyComp: Flushing any bits left in the accumulator\n");
-        if (write_bits(comp, params, UINT_MAX, 0))
-          status = GKeyStatus_Finished;
-        else
+        if (!write_bits(comp, params, UINT_MAX, 0))
           status = GKeyStatus_BufferOverflow;
+        else if (comp->verifier != NULL &&
+                 (!verify_output(comp) || comp->verified != comp->in_total))
+          status = GKeyStatus_VerifyFailed;
+        else
+          status = GKeyStatus_Finished;
         /* We never leave this state because writing data after a flush would
            produce corrupt output */
         break;
@@ -713,9 +2103,128 @@ GKeyStatus gkeycomp_compress(GKeyComp       *comp,
 
   comp->state = state;
 
+  if (comp->scratch_pool != NULL)
+    return_scratch(comp);
+
+  if (comp->stats != NULL)
+    comp->stats->total_ticks += read_clock(comp) - start_time;
+
+  if (status == GKeyStatus_BufferOverflow)
+    GKEY_PROBE2(compress_overflow, comp, (int)state);
+
+  GKEY_PROBE4(compress_return, comp, (int)status,
+              params->in_size, params->out_size);
+
+  if (comp->trace != NULL)
+  {
+    record_event(comp, GKeyTraceType_Return, state,
+                 status, params->out_size);
+  }
+
   DEBUGF("GKeyComp: Returning status %s in state %s\n",
          GKey_get_status_str(status),
          get_state_str(state));
 
   return status;
 }
+
+static GKeyStatus compress_stage(GKeyComp       *comp,
+                                 GKeyParameters *params)
+{
+  GKeyParameters stage_params = *params;
+  GKeyStatus status;
+
+  assert(comp != NULL);
+  assert(comp->stage_pos < comp->stage_count);
+
+  stage_params.in_buffer = comp->stage + comp->stage_pos;
+  stage_params.in_size = comp->stage_count - comp->stage_pos;
+  status = compress(comp, &stage_params);
+
+  params->out_buffer = stage_params.out_buffer;
+  params->out_size = stage_params.out_size;
+
+  if (stage_params.in_size == 0)
+  {
+    comp->stage_count = comp->stage_pos = 0;
+  }
+  else
+  {
+    /* Resume from the same place when more output space is available */
+    assert(status != GKeyStatus_OK);
+    comp->stage_pos = comp->stage_count - stage_params.in_size;
+  }
+
+  return status;
+}
+
+GKeyStatus gkeycomp_compress(GKeyComp       *comp,
+                             GKeyParameters *params)
+{
+  GKeyStatus status = GKeyStatus_OK;
+  bool flush;
+
+  assert(comp != NULL);
+  assert(params != NULL);
+
+  if (comp->stage == NULL)
+    return compress(comp, params);
+
+  /* Input is collected in the staging buffer until it is full, or until
+     the caller asks for the output to be flushed */
+  flush = (params->in_size == 0);
+  do
+  {
+    if (comp->stage_count > 0 &&
+        (flush || comp->stage_count == comp->stage_size))
+    {
+      status = compress_stage(comp, params);
+    }
+    else if (flush || (comp->stage_count == 0 &&
+                       params->in_size >= comp->stage_size))
+    {
+      /* Large inputs needn't be copied */
+      status = compress(comp, params);
+      break;
+    }
+    else
+    {
+      const size_t n = LOWEST(params->in_size,
+                              comp->stage_size - comp->stage_count);
+
+      DEBUG_VERBOSEF("GKeyComp: Staging %zu bytes\n", n);
+      memcpy(comp->stage + comp->stage_count, params->in_buffer, n);
+      comp->stage_count += n;
+
+      params->in_buffer = (const char *)params->in_buffer + n;
+      params->in_size -= n;
+    }
+  }
+  while (status == GKeyStatus_OK && (flush || params->in_size > 0 ||
+                                     comp->stage_count == comp->stage_size));
+
+  return status;
+}
+
+static GKeyStatus stream_fn(void *context, GKeyParameters *params)
+{
+  return gkeycomp_compress(context, params);
+}
+
+GKeyStatus gkeycomp_compress_vec(GKeyComp          *comp,
+                                 GKeyVecParameters *params)
+{
+  assert(comp != NULL);
+  return GKeyStream_run_vec(stream_fn, comp, params);
+}
+
+GKeyStatus gkeycomp_stream(GKeyComp                   *comp,
+                           const GKeyStreamParameters *params)
+{
+  assert(comp != NULL);
+
+  /* A compressor in caller-owned memory has no allocator */
+  return GKeyStream_run(stream_fn, comp, params,
+                        comp->allocator.alloc != NULL ? &comp->allocator :
+                                                        NULL);
+}
@@ -25,11 +25,31 @@ History:
   CJB: 08-Jan-11: gkeycomp_compress() no longer returns status
                   TruncatedInput (flush is always required anyway).
   CJB: 06-Dec-20: Clarified documentation of gkeycomp_compress().
+  CJB: 16-Oct-26: Added gkeycomp_set_mode() and GKeyCompMode.
+                  Added gkeycomp_make_with_allocator().
+                  Added gkeycomp_state_size() and gkeycomp_init_in().
+                  Added gkeycomp_pool_make(), gkeycomp_pool_get() and
+                  gkeycomp_pool_put().
+                  Added gkeycomp_scratch_pool_make() and
+                  gkeycomp_make_shared().
+                  Added gkeycomp_stream() and gkeycomp_compress_vec().
+                  Added gkeycomp_set_staging().
+                  Added gkeycomp_set_progress().
+                  Added GKeyCompMode_Deadline and gkeycomp_set_deadline().
+                  Added gkeycomp_set_verify().
+                  Added GKeyCompStats and gkeycomp_set_stats().
+                  Added gkeycomp_set_trace().
+                  Documented memory usage for large histories.
+                  Added GKeyCompClockFn and gkeycomp_set_clock().
 */
 
 #ifndef GKeyComp_h
 #define GKeyComp_h
 
+/* ISO library headers */
+#include <signal.h>
+#include <time.h>
+
 /* Local headers */
 #include "GKey.h"
 
@@ -38,20 +58,161 @@ typedef struct GKeyComp GKeyComp;
     * Opaque definition of retained state for a compressor.
     */
 
+typedef enum
+{
+  GKeyCompMode_Best,     /* Always search for the longest matching sequence */
+  GKeyCompMode_Adaptive, /* Stop searching after repeatedly failing to find
+                            sequences worth copying (e.g. in random or
+                            already-compressed data), except for occasional
+                            probes to detect when matches become likely */
+  GKeyCompMode_Bounded,  /* Limit the search for each sequence to the most
+                            recent part of the history and a fixed number of
+                            candidates, and stop when a sequence is long
+                            enough, so that compression time is linear in
+                            the size of the input whatever its content */
+  GKeyCompMode_Deadline  /* Switch between searching for the longest
+                            sequence, a bounded search and not searching
+                            (except for runs), depending on whether the
+                            compressor is ahead of or behind the schedule
+                            set by gkeycomp_set_deadline() */
+}
+GKeyCompMode;
+
+enum
+{
+  GKeyCompStatsLengthBins = 24 /* No. of bins in the histogram of copy
+                                  sizes (enough for any history size) */
+};
+
+typedef struct
+{
+  size_t literals;     /* No. of bytes output as literal values */
+  size_t copies;       /* No. of copy commands output */
+  size_t short_sizes;  /* No. of copy commands with a size field one bit
+                          narrower than the history size (because the offset
+                          is in the upper half of the history) */
+  size_t full_sizes;   /* No. of copy commands with a full-width size field */
+  size_t lengths[GKeyCompStatsLengthBins]; /* No. of copy commands of each
+                          size, where bin n counts sizes from 2^n to
+                          2^(n+1)-1 bytes */
+  size_t find_char_bytes; /* No. of bytes of history searched for the first
+                             character of a sequence */
+  size_t compare_bytes;   /* No. of bytes of history compared with the
+                             input or with other sequences */
+  size_t searches;     /* No. of times the compressor was in the state of
+                          searching for a sequence */
+  size_t stalls;       /* No. of searches that had to be resumed because the
+                          input ran out */
+  clock_t search_ticks; /* Estimated clock time spent searching for
+                           sequences, from a sample of searches. Inaccurate
+                           if most searches take less time than the
+                           resolution of the clock (e.g. small histories) */
+  clock_t total_ticks;  /* Clock time spent in calls to compress */
+}
+GKeyCompStats;
+   /*
+    * Statistics about the work done by a compressor, collected if enabled by
+    * calling gkeycomp_set_stats(). The difference between 'total_ticks'
+    * and 'search_ticks' is roughly the time spent encoding the output.
+    * Times are measured by the compressor's clock (see gkeycomp_set_clock).
+    */
+
+typedef clock_t GKeyCompClockFn(void *arg);
+   /*
+    * Type of function called back to read a clock, in the same units as
+    * the value returned by the standard library function clock. It may
+    * return (clock_t)-1 if the time is unavailable. The value of 'arg' is
+    * that passed to gkeycomp_set_clock().
+    */
+
 GKeyComp *gkeycomp_make(unsigned int /*history_log_2*/);
    /*
     * Creates a compressor by allocating memory for, and initialising,
     * internal buffers and data structures. The history_log_2 parameter
     * is the no. of bytes to look behind, in base 2 logarithmic form, and
-    * must be the same as that used to decompress the data.
+    * must be the same as that used to decompress the data. Histories
+    * of 64 KB or more are searched using hash chains, which require up to
+    * 4.25 MB of additional memory.
     * Returns: If successful, a pointer to retained state for the new
     *          decompressor, otherwise NULL (not enough free memory).
     */
 
+GKeyComp *gkeycomp_make_with_allocator(
+                          unsigned int         /*history_log_2*/,
+                          const GKeyAllocator */*allocator*/);
+   /*
+    * Creates a compressor in the same way as gkeycomp_make() except that
+    * memory is allocated (and later freed) using a specified allocator,
+    * which is copied. If 'allocator' is a null pointer then the allocator
+    * set by GKey_set_allocator() is used.
+    * Returns: If successful, a pointer to retained state for the new
+    *          compressor, otherwise NULL (not enough free memory).
+    */
+
+size_t gkeycomp_state_size(unsigned int /*history_log_2*/);
+   /*
+    * Gets the amount of memory required for a compressor, including its
+    * internal buffers and data structures. The history_log_2 parameter is
+    * the no. of bytes to look behind, in base 2 logarithmic form.
+    * Returns: size of a compressor in bytes.
+    */
+
+GKeyComp *gkeycomp_init_in(void         */*buffer*/,
+                           size_t        /*size*/,
+                           unsigned int  /*history_log_2*/);
+   /*
+    * Creates a compressor in a block of memory owned by the caller, such
+    * as static storage or a member of another struct, instead of allocating
+    * memory. The block at 'buffer' must be suitably aligned for any type of
+    * object, and 'size' must be at least the value returned by
+    * gkeycomp_state_size() for the same history_log_2. The block must not
+    * be used for anything else until the compressor is no longer needed.
+    * Returns: If successful, a pointer to retained state for the new
+    *          compressor (equal to 'buffer'), otherwise NULL (size too
+    *          small).
+    */
+
+GKeyPool *gkeycomp_scratch_pool_make(unsigned int         /*history_log_2*/,
+                                     size_t               /*max_free*/,
+                                     const GKeyAllocator */*allocator*/,
+                                     const GKeyPoolLock  */*lock*/);
+   /*
+    * Creates a pool of scratch memory for compressors created by
+    * gkeycomp_make_shared() with the same history size. Scratch memory
+    * holds the data structures used to find matching sequences (an index
+    * for histories up to 512 bytes, or hash chains for histories of 64
+    * KB or more). It is created on demand and up to 'max_free' are kept for
+    * reuse, which should be about the number of threads compressing at
+    * once. The other parameters are as for gkeycomp_pool_make().
+    * Returns: If successful, a pointer to the new pool, otherwise NULL
+    *          (not enough free memory).
+    */
+
+GKeyComp *gkeycomp_make_shared(unsigned int         /*history_log_2*/,
+                               GKeyPool            */*scratch_pool*/,
+                               const GKeyAllocator */*allocator*/);
+   /*
+    * Creates a compressor in the same way as gkeycomp_make_with_allocator()
+    * except that it only holds its history and the state of its output.
+    * Scratch memory is borrowed from a pool created by
+    * gkeycomp_scratch_pool_make() during each call to gkeycomp_compress()
+    * and returned before it returns, so that memory usage scales with the
+    * number of compressors in use instead of the number in existence.
+    * Scratch memory is rebuilt from the history when borrowed, unless it
+    * was last used by the same compressor; that takes time proportional to
+    * the history size, so large amounts of input per call are most
+    * efficient. The output is the same as from an unshared compressor.
+    * If no scratch memory can be allocated then compression is slower.
+    * The pool must not be destroyed before the compressor.
+    * Returns: If successful, a pointer to retained state for the new
+    *          compressor, otherwise NULL (not enough free memory).
+    */
+
 void gkeycomp_destroy(GKeyComp */*comp*/);
    /*
     * Frees memory that was previously allocated for a compressor.
-    * Does nothing if called with a null pointer.
+    * Does nothing if called with a null pointer or a compressor created
+    * by gkeycomp_init_in().
     */
 
 void gkeycomp_reset(GKeyComp */*comp*/);
@@ -60,6 +221,146 @@ void gkeycomp_reset(GKeyComp */*comp*/);
     * of data (as though newly created).
     */
 
+GKeyPool *gkeycomp_pool_make(unsigned int         /*history_log_2*/,
+                             size_t               /*max_free*/,
+                             const GKeyAllocator */*allocator*/,
+                             const GKeyPoolLock  */*lock*/);
+   /*
+    * Creates a pool of compressors with the same history size, which are
+    * created on demand and reset for reuse instead of being destroyed.
+    * Up to 'max_free' compressors are kept for reuse. Memory is allocated
+    * using a specified allocator, or the allocator set by
+    * GKey_set_allocator() if 'allocator' is a null pointer. A pool can
+    * only be shared between threads if 'lock' is not a null pointer; for
+    * the least contention, give each thread its own pool without a lock.
+    * Returns: If successful, a pointer to the new pool, otherwise NULL
+    *          (not enough free memory).
+    */
+
+GKeyComp *gkeycomp_pool_get(GKeyPool */*pool*/);
+   /*
+    * Gets a compressor from a pool created by gkeycomp_pool_make(), either
+    * by resetting one that was returned to the pool or by creating a new
+    * one. Its mode is GKeyCompMode_Best.
+    * Returns: If successful, a pointer to retained state for the
+    *          compressor, otherwise NULL (not enough free memory).
+    */
+
+void gkeycomp_pool_put(GKeyPool */*pool*/, GKeyComp */*comp*/);
+   /*
+    * Returns a compressor to the pool from which it was got, so that it
+    * can be reused. It is destroyed instead if the pool is full. Does
+    * nothing if called with a null pointer.
+    */
+
+void gkeycomp_set_mode(GKeyComp     */*comp*/,
+                       GKeyCompMode  /*mode*/);
+   /*
+    * Sets the strategy used by a compressor to search for matching
+    * sequences. The mode can be changed at any time and persists when the
+    * compressor is reset. Modes other than GKeyCompMode_Best trade worse
+    * compression for speed, but the output can still be decompressed in
+    * the usual way. The default is GKeyCompMode_Best.
+    */
+
+void gkeycomp_set_progress(GKeyComp              */*comp*/,
+                           size_t                /*interval*/,
+                           volatile sig_atomic_t */*cancel*/);
+   /*
+    * Sets how often a compressor reports progress and checks whether the
+    * operation should be cancelled. Progress is only reported (by calling
+    * the function specified in the parameters, if any) after at least
+    * 'interval' bytes have been consumed or output since it was last
+    * reported. If 'cancel' is not a null pointer then the object that it
+    * points to is read at the same times, and the operation is aborted if
+    * its value is non-zero; it may be set by a signal handler. Setting it
+    * from another thread relies on the platform making loads and stores of
+    * sig_atomic_t atomic and visible to other threads, which C99 doesn't
+    * guarantee. The settings persist when the compressor is reset. The
+    * default is to report progress for every command, and not to check
+    * for cancellation.
+    */
+
+void gkeycomp_set_deadline(GKeyComp */*comp*/,
+                           size_t    /*in_size*/,
+                           clock_t   /*ticks*/);
+   /*
+    * Sets the schedule for a compressor in mode GKeyCompMode_Deadline: it
+    * should consume 'in_size' bytes of input within 'ticks' units of time
+    * as measured by the compressor's clock (see gkeycomp_set_clock), from
+    * the first call to gkeycomp_compress() after this function or
+    * gkeycomp_reset() was called. The default clock measures processor
+    * time used by the whole program, not elapsed time: time spent waiting
+    * (e.g. for input) doesn't count, whereas time used by other threads
+    * does. Progress is checked periodically. If
+    * the compressor is behind schedule then it makes less effort to find
+    * matching sequences; if well ahead, then it makes more effort (up to
+    * that of GKeyCompMode_Best). Once the deadline has passed or 'in_size'
+    * bytes have been consumed, it only looks for runs of the same byte.
+    * The schedule persists when the compressor is reset.
+    */
+
+void gkeycomp_set_clock(GKeyComp        */*comp*/,
+                        GKeyCompClockFn */*clock_fn*/,
+                        void            */*arg*/);
+   /*
+    * Sets the function called by a compressor to measure time for
+    * GKeyCompMode_Deadline and statistics, with 'arg' as its argument.
+    * This allows a monotonic wall clock to be used instead of processor
+    * time. Any schedule set by gkeycomp_set_deadline() is restarted from
+    * the next call to gkeycomp_compress(). The setting persists when the
+    * compressor is reset. If 'clock_fn' is a null pointer then the
+    * standard library function clock is used, which is the default.
+    */
+
+bool gkeycomp_set_verify(GKeyComp */*comp*/, bool /*verify*/);
+   /*
+    * Enables or disables verification of the output of a compressor. When
+    * enabled, the output is decompressed as it is produced, using a
+    * separate history, and compared with a copy of the most recently
+    * consumed input. Compression stops with status VerifyFailed as soon
+    * as a difference is found. This requires additional memory for three
+    * times the history size. The default is not to verify. Should be
+    * called before any data is compressed, or after a reset. Not supported
+    * for a compressor in caller-owned memory.
+    * Returns: true if successful, otherwise false (e.g. not enough memory).
+    */
+
+void gkeycomp_set_stats(GKeyComp */*comp*/, GKeyCompStats */*stats*/);
+   /*
+    * Enables or disables collection of statistics by a compressor. If
+    * 'stats' is not a null pointer then the object that it points to is
+    * zeroed, then updated by subsequent calls to compress data (including
+    * after the compressor is reset) until collection is disabled by passing
+    * a null pointer, which is the default. The object must remain valid
+    * until then. There is no extra cost when disabled, and little when
+    * enabled.
+    */
+
+void gkeycomp_set_trace(GKeyComp */*comp*/, GKeyTrace */*trace*/);
+   /*
+    * Enables or disables recording of events by a compressor, such as
+    * calls, state changes and decisions to put literal values or copy
+    * commands. If 'trace' is not a null pointer then events are recorded
+    * in the ring that it points to, which may be shared with other
+    * compressors or decompressors (but not between threads). Passing a null
+    * pointer disables tracing, which is the default; tracing then costs
+    * almost nothing. The setting persists when the compressor is reset.
+    */
+
+bool gkeycomp_set_staging(GKeyComp */*comp*/, size_t /*block_size*/);
+   /*
+    * Enables or disables an internal buffer in which a compressor collects
+    * input until at least 'block_size' bytes are available to be searched
+    * for matching sequences. This reduces the overhead of compressing data
+    * supplied in small chunks (e.g. a few bytes at a time) without changing
+    * the output. Input copied into the buffer is treated as consumed. A
+    * 'block_size' of 0 disables staging, which is the default. Should be
+    * called before any data is compressed, or after a reset. Not supported
+    * for a compressor in caller-owned memory.
+    * Returns: true if successful, otherwise false (e.g. not enough memory).
+    */
+
 GKeyStatus gkeycomp_compress(GKeyComp       */*comp*/,
                              GKeyParameters */*params*/);
    /*
@@ -75,4 +376,30 @@ GKeyStatus gkeycomp_compress(GKeyComp       */*comp*/,
     * Returns: status of the compressor (e.g. output buffer overflow).
     */
 
+GKeyStatus gkeycomp_compress_vec(GKeyComp          */*comp*/,
+                                 GKeyVecParameters */*params*/);
+   /*
+    * Compresses data in the same way as gkeycomp_compress() except that
+    * the input and output buffers are specified as arrays of segments by
+    * the 'params' object, which is updated to reflect the data consumed
+    * and output. The output cannot be discarded to calculate its size. To
+    * flush pending output, call with no input segments (or only empty
+    * ones).
+    * Returns: status of the compressor (e.g. output buffer overflow if all
+    *          of the output segments are full).
+    */
+
+GKeyStatus gkeycomp_stream(GKeyComp                   */*comp*/,
+                           const GKeyStreamParameters */*params*/);
+   /*
+    * Compresses a whole stream of data in one call, reading input and
+    * writing output in large chunks via the callback functions specified by
+    * the 'params' object, until the read function reports the end of the
+    * input. Pending output is flushed at the end, as by gkeycomp_compress().
+    * Two 32 KB buffers are allocated temporarily, using the compressor's
+    * allocator.
+    * Returns: GKeyStatus_Finished if successful, GKeyStatus_Aborted if a
+    *          callback function returned false, or GKeyStatus_NoMem.
+    */
+
 #endif
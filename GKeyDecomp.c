@@ -32,6 +32,24 @@
                   to cast the matching parameters.
   CJB: 15-May-16: Fixed a null pointer dereference in gkeydecomp_destroy.
   CJB: 21-Jan-18: Made debugging output even less verbose.
+  CJB: 16-Oct-26: Added gkeydecomp_make_with_allocator.
+                  Added gkeydecomp_state_size and gkeydecomp_init_in.
+                  The ring buffer is now allocated in the same block of
+                  memory as the decompressor.
+                  Added functions to get decompressors from a pool.
+                  Added gkeydecomp_stream and gkeydecomp_decompress_vec.
+                  Added gkeydecomp_set_progress, which allows progress to be
+                  reported less often and cancellation via a flag.
+                  Added gkeydecomp_set_budget, which limits the amount of
+                  output per call.
+                  Added gkeydecomp_set_checksum, which enables calculation
+                  of a CRC-32 of the output as it is produced.
+                  Added gkeydecomp_set_stats, which enables collection of
+                  statistics about the input.
+                  Added gkeydecomp_set_trace, which enables recording of
+                  events such as state changes and commands decoded.
+                  Added static tracepoints, which are enabled by defining
+                  GKEY_USDT.
 */
 
 /* ISO library header files */
@@ -40,10 +58,18 @@
 #include <string.h>
 #include <limits.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <signal.h>
 
 /* Local headers */
 #include "Internal/GKeyMisc.h"
 #include "Internal/RingBuffer.h"
+#include "Internal/GKeyAlloc.h"
+#include "Internal/GKeyPool.h"
+#include "Internal/GKeyStream.h"
+#include "Internal/GKeyCRC.h"
+#include "Internal/GKeyTrace.h"
+#include "Internal/GKeyProbes.h"
 #include "GKey.h"
 #include "GKeyDecomp.h"
 
@@ -83,8 +109,22 @@ struct GKeyDecomp
   unsigned long acc;     /* Accumulator for bits read from the input buffer */
   char acc_nbits;        /* No. of bits valid in the accumulator */
   char literal;          /* Byte value to be written at the output position */
+  size_t progress_due;   /* Sum of 'in_total' and 'out_total' at which to
+                            report progress next */
+  unsigned long crc;     /* CRC-32 of the output so far */
   char history_log_2;    /* Size of ring buffer as a base 2 logarithm */
+  GKeyAllocator allocator; /* Used to free memory, or all null if the
+                              memory belongs to the client */
   RingBuffer *history;   /* Ring buffer containing recently decompressed data */
+  size_t progress_interval; /* Minimum no. of bytes consumed or output
+                               between reports of progress */
+  volatile sig_atomic_t *cancel; /* Flag to be checked whenever progress is
+                                    due, or NULL if none */
+  size_t budget;         /* Maximum no. of bytes to output per call, or 0 if
+                            unlimited */
+  bool checksum;         /* Calculate the CRC-32 of the output? */
+  GKeyDecompStats *stats; /* Statistics to be updated, or NULL */
+  GKeyTrace *trace;      /* Ring in which to record events, or NULL */
 };
 
 typedef struct
@@ -108,6 +148,10 @@ static size_t ring_writer(void *arg, const void *src, size_t n)
   {
     /* No output buffer was provided so update the required size. */
     params->out_size += n;
+
+    /* The checksum can't be calculated later, so do it now */
+    if (rwp->decomp->checksum)
+      rwp->decomp->crc = GKey_crc32(rwp->decomp->crc, src, n);
   }
   else
   {
@@ -214,6 +258,15 @@ static bool read_bits(GKeyDecomp *decomp, GKeyParameters *params, unsigned int n
   return success;
 }
 
+static void record_event(const GKeyDecomp *decomp, GKeyTraceType type,
+                         GKeyDecompState state, size_t arg1, size_t arg2)
+{
+  assert(decomp != NULL);
+  assert(decomp->trace != NULL);
+  GKeyTrace_record(decomp->trace, GKeyTraceSource_Decomp, type, state,
+                   decomp->out_total, arg1, arg2);
+}
+
 static const char *get_state_str(GKeyDecompState state)
 {
 #ifdef DEBUG_OUTPUT
@@ -236,16 +289,64 @@ static const char *get_state_str(GKeyDecompState state)
 }
 
 GKeyDecomp *gkeydecomp_make(unsigned int history_log_2)
+{
+  return gkeydecomp_make_with_allocator(history_log_2, NULL);
+}
+
+GKeyDecomp *gkeydecomp_make_with_allocator(unsigned int         history_log_2,
+                                           const GKeyAllocator *allocator)
+{
+  const size_t size = gkeydecomp_state_size(history_log_2);
+  void * const buffer = GKey_alloc(allocator, size);
+  GKeyDecomp *decomp = NULL;
+
+  if (buffer != NULL)
+  {
+    decomp = gkeydecomp_init_in(buffer, size, history_log_2);
+    assert(decomp != NULL);
+    GKey_get_allocator(&decomp->allocator, allocator);
+  }
+
+  return decomp;
+}
+
+size_t gkeydecomp_state_size(unsigned int history_log_2)
 {
   assert(history_log_2 <= MaxHistoryLog2);
-  GKeyDecomp *decomp = malloc(sizeof(*decomp));
-  if (decomp != NULL)
+  return GKey_align_size(sizeof(GKeyDecomp)) +
+         RingBuffer_state_size(history_log_2);
+}
+
+GKeyDecomp *gkeydecomp_init_in(void         *buffer,
+                               size_t        size,
+                               unsigned int  history_log_2)
+{
+  GKeyDecomp *decomp = NULL;
+
+  assert(buffer != NULL || size == 0);
+  if (size >= gkeydecomp_state_size(history_log_2))
   {
+    /* The ring buffer immediately follows the decompressor */
+    decomp = buffer;
     memset(decomp, 0, offsetof(GKeyDecomp, history_log_2));
     decomp->history_log_2 = history_log_2;
-    decomp->history = RingBuffer_make(history_log_2);
-    if (decomp->history == NULL)
-      FREE_SAFE(decomp);
+    decomp->allocator.alloc = NULL;
+    decomp->allocator.free = NULL;
+    decomp->allocator.arg = NULL;
+    decomp->progress_interval = 0;
+    decomp->cancel = NULL;
+    decomp->budget = 0;
+    decomp->checksum = false;
+    decomp->stats = NULL;
+    decomp->trace = NULL;
+    decomp->history = (RingBuffer *)((char *)buffer +
+                                     GKey_align_size(sizeof(*decomp)));
+    RingBuffer_init(decomp->history, history_log_2);
+  }
+  else
+  {
+    DEBUGF("GKeyDecomp: %zu bytes is too small for history %u\n",
+           size, history_log_2);
   }
 
   return decomp;
@@ -253,10 +354,11 @@ GKeyDecomp *gkeydecomp_make(unsigned int history_log_2)
 
 void gkeydecomp_destroy(GKeyDecomp *decomp)
 {
-  if (decomp != NULL)
+  if (decomp != NULL && decomp->allocator.free != NULL)
   {
-    RingBuffer_destroy(decomp->history);
-    free(decomp);
+    /* Copy the allocator because it is part of the object to be freed */
+    const GKeyAllocator allocator = decomp->allocator;
+    GKey_free(&allocator, decomp);
   }
 }
 
@@ -267,7 +369,119 @@ void gkeydecomp_reset(GKeyDecomp *decomp)
   RingBuffer_reset(decomp->history);
 }
 
-GKeyStatus gkeydecomp_decompress(GKeyDecomp *decomp, GKeyParameters *params)
+static void *pool_make(unsigned int         history_log_2,
+                       const GKeyAllocator *allocator)
+{
+  return gkeydecomp_make_with_allocator(history_log_2, allocator);
+}
+
+static void pool_reset(void *object)
+{
+  /* Objects got from a pool must be as though newly created */
+  gkeydecomp_reset(object);
+  gkeydecomp_set_progress(object, 0, NULL);
+  gkeydecomp_set_budget(object, 0);
+  gkeydecomp_set_checksum(object, false);
+  gkeydecomp_set_stats(object, NULL);
+  gkeydecomp_set_trace(object, NULL);
+}
+
+static void pool_destroy(void *object)
+{
+  gkeydecomp_destroy(object);
+}
+
+static const GKeyPoolType pool_type = { pool_make, pool_reset, pool_destroy };
+
+GKeyPool *gkeydecomp_pool_make(unsigned int         history_log_2,
+                               size_t               max_free,
+                               const GKeyAllocator *allocator,
+                               const GKeyPoolLock  *lock)
+{
+  assert(history_log_2 <= MaxHistoryLog2);
+  return GKeyPool_make(&pool_type, history_log_2, max_free, allocator, lock);
+}
+
+GKeyDecomp *gkeydecomp_pool_get(GKeyPool *pool)
+{
+  return GKeyPool_get(pool, &pool_type);
+}
+
+void gkeydecomp_pool_put(GKeyPool *pool, GKeyDecomp *decomp)
+{
+  GKeyPool_put(pool, &pool_type, decomp);
+}
+
+void gkeydecomp_set_progress(GKeyDecomp            *decomp,
+                             size_t                 interval,
+                             volatile sig_atomic_t *cancel)
+{
+  assert(decomp != NULL);
+  DEBUGF("GKeyDecomp: Setting progress interval %zu and cancel flag %p\n",
+         interval, (void *)cancel);
+  decomp->progress_interval = interval;
+  decomp->cancel = cancel;
+}
+
+void gkeydecomp_set_budget(GKeyDecomp *decomp, size_t budget)
+{
+  assert(decomp != NULL);
+  DEBUGF("GKeyDecomp: Setting budget %zu\n", budget);
+  decomp->budget = budget;
+}
+
+void gkeydecomp_set_trace(GKeyDecomp *decomp, GKeyTrace *trace)
+{
+  assert(decomp != NULL);
+  DEBUGF("GKeyDecomp: Setting trace %p\n", (void *)trace);
+  decomp->trace = trace;
+}
+
+void gkeydecomp_set_stats(GKeyDecomp *decomp, GKeyDecompStats *stats)
+{
+  assert(decomp != NULL);
+  DEBUGF("GKeyDecomp: Setting stats %p\n", (void *)stats);
+  if (stats != NULL)
+    memset(stats, 0, sizeof(*stats));
+
+  decomp->stats = stats;
+}
+
+void gkeydecomp_set_checksum(GKeyDecomp *decomp, bool checksum)
+{
+  assert(decomp != NULL);
+  assert(decomp->out_total == 0);
+  DEBUGF("GKeyDecomp: %sabling checksum\n", checksum ? "En" : "Dis");
+  decomp->checksum = checksum;
+}
+
+unsigned long gkeydecomp_get_checksum(const GKeyDecomp *decomp)
+{
+  assert(decomp != NULL);
+  assert(decomp->checksum);
+  return decomp->crc;
+}
+
+typedef struct
+{
+  GKeyDecomp *decomp;
+  size_t      out_limit;
+}
+VecContext;
+
+static size_t get_out_limit(const GKeyDecomp *decomp)
+{
+  /* Stop when the value of 'out_total' reaches this limit */
+  size_t out_limit = SIZE_MAX;
+  if (decomp->budget > 0)
+    out_limit = decomp->out_total + LOWEST(decomp->budget,
+                                           SIZE_MAX - decomp->out_total);
+  return out_limit;
+}
+
+static GKeyStatus decompress(GKeyDecomp     *decomp,
+                             GKeyParameters *params,
+                             size_t          out_limit)
 {
   GKeyStatus status = GKeyStatus_OK;
   GKeyDecompState state;
@@ -275,34 +489,75 @@ GKeyStatus gkeydecomp_decompress(GKeyDecomp *decomp, GKeyParameters *params)
   unsigned long bits;
   unsigned int nbits;
   bool stop = false;
-  size_t copied;
+  size_t copied, total, to_copy;
   RingWriterParams rwp;
+  const unsigned char *out_start;
+  GKeyDecompState traced_state;
 
   assert(decomp != NULL);
   assert(params != NULL);
 
-  state = decomp->state;
+  state = traced_state = decomp->state;
   prog_cb = params->prog_cb;
+  out_start = params->out_buffer;
+
+  GKEY_PROBE3(decompress_entry, decomp, params->in_size, params->out_size);
+  if (state == GKeyDecompState_CopyData || state == GKeyDecompState_PutByte)
+  {
+    /* Output was pending when the previous call returned */
+    GKEY_PROBE2(decompress_resume, decomp, (int)state);
+  }
+
+  if (decomp->trace != NULL)
+  {
+    record_event(decomp, GKeyTraceType_Call, state,
+                 params->in_size, params->out_size);
+  }
 
   do
   {
+    if (decomp->trace != NULL && state != traced_state)
+    {
+      record_event(decomp, GKeyTraceType_State, state, traced_state, 0);
+      traced_state = state;
+    }
+
     switch (state)
     {
       case GKeyDecompState_Progress:
-        /* Do a callback to report progress, if a function was supplied. */
-        DEBUG_VERBOSEF("GKeyDecomp: Reporting progress (%zu in, %zu out)\n",
-                       decomp->in_total, decomp->out_total);
-        if (prog_cb != NULL)
+        total = decomp->in_total + decomp->out_total;
+        if (decomp->out_total >= out_limit)
         {
-          if (prog_cb(params->cb_arg, decomp->in_total, decomp->out_total))
-            state = GKeyDecompState_GetType;
-          else
-            status = GKeyStatus_Aborted;
+          DEBUG_VERBOSEF("GKeyDecomp: Budget used up\n");
+          status = GKeyStatus_Suspended;
         }
-        else
+        else if (total < decomp->progress_due)
         {
+          /* Not enough has happened since progress was last reported */
           state = GKeyDecompState_GetType;
         }
+        else if (decomp->cancel != NULL && *decomp->cancel != 0)
+        {
+          DEBUGF("GKeyDecomp: Cancelled\n");
+          status = GKeyStatus_Aborted;
+        }
+        else
+        {
+          /* Do a callback to report progress, if a function was supplied. */
+          DEBUG_VERBOSEF("GKeyDecomp: Reporting progress (%zu in, %zu out)\n",
+                         decomp->in_total, decomp->out_total);
+          if (prog_cb == NULL ||
+              prog_cb(params->cb_arg, decomp->in_total, decomp->out_total))
+          {
+            decomp->progress_due = total + LOWEST(decomp->progress_interval,
+                                                  SIZE_MAX - total);
+            state = GKeyDecompState_GetType;
+          }
+          else
+          {
+            status = GKeyStatus_Aborted;
+          }
+        }
         if (state != GKeyDecompState_GetType)
           break;
         /* FALLTHROUGH */
@@ -370,6 +625,19 @@ GKeyStatus gkeydecomp_decompress(GKeyDecomp *decomp, GKeyParameters *params)
           {
             decomp->read_size = (size_t)bits;
             state = GKeyDecompState_CopyData;
+            GKEY_PROBE3(decompress_copy, decomp,
+                        decomp->read_offset, decomp->read_size);
+            if (decomp->trace != NULL)
+            {
+              record_event(decomp, GKeyTraceType_Copy, state,
+                           decomp->read_offset, decomp->read_size);
+              traced_state = state;
+            }
+            if (decomp->stats != NULL)
+            {
+              ++decomp->stats->copies;
+              decomp->stats->copy_bytes += decomp->read_size;
+            }
           }
         }
         else
@@ -387,12 +655,13 @@ GKeyStatus gkeydecomp_decompress(GKeyDecomp *decomp, GKeyParameters *params)
            current output pointer. */
         rwp.params = params;
         rwp.decomp = decomp;
+        to_copy = LOWEST(decomp->read_size, out_limit - decomp->out_total);
         copied = RingBuffer_copy(decomp->history,
                                  ring_writer,
                                  &rwp,
                                  decomp->read_offset,
-                                 decomp->read_size);
-        assert(copied <= decomp->read_size);
+                                 to_copy);
+        assert(copied <= to_copy);
         if (copied >= decomp->read_size)
         {
           state = GKeyDecompState_Progress; /* next command */
@@ -403,7 +672,10 @@ GKeyStatus gkeydecomp_decompress(GKeyDecomp *decomp, GKeyParameters *params)
              the changed write position. Read offset is relative to the write
              position, so no need to update that. */
           decomp->read_size -= copied;
-          status = GKeyStatus_BufferOverflow;
+          if (copied < to_copy)
+            status = GKeyStatus_BufferOverflow;
+          else
+            status = GKeyStatus_Suspended;
         }
         break;
 
@@ -415,6 +687,12 @@ GKeyStatus gkeydecomp_decompress(GKeyDecomp *decomp, GKeyParameters *params)
           assert(bits <= UCHAR_MAX);
           decomp->literal = (char)bits;
           state = GKeyDecompState_PutByte;
+          GKEY_PROBE2(decompress_literal, decomp, bits);
+          if (decomp->trace != NULL)
+          {
+            record_event(decomp, GKeyTraceType_Literal, state, bits, 0);
+            traced_state = state;
+          }
         }
         else
         {
@@ -440,6 +718,8 @@ GKeyStatus gkeydecomp_decompress(GKeyDecomp *decomp, GKeyParameters *params)
         {
           RingBuffer_write(decomp->history, &decomp->literal, 1);
           state = GKeyDecompState_Progress; /* next command */
+          if (decomp->stats != NULL)
+            ++decomp->stats->literals;
         }
         else
         {
@@ -456,9 +736,74 @@ GKeyStatus gkeydecomp_decompress(GKeyDecomp *decomp, GKeyParameters *params)
 
   decomp->state = state;
 
+  /* Include all of the output from this call in the checksum. One call for
+     the whole output is much faster than one per command (most of which
+     are short) and, unless the output buffer is huge, it is still in the
+     cache. */
+  if (decomp->checksum && out_start != NULL)
+  {
+    decomp->crc = GKey_crc32(decomp->crc, out_start,
+                             (size_t)((const unsigned char *)params->out_buffer -
+                                      out_start));
+  }
+
+  if (status == GKeyStatus_BufferOverflow)
+    GKEY_PROBE2(decompress_overflow, decomp, (int)state);
+
+  GKEY_PROBE4(decompress_return, decomp, (int)status,
+              params->in_size, params->out_size);
+
+  if (decomp->trace != NULL)
+  {
+    record_event(decomp, GKeyTraceType_Return, state,
+                 status, params->out_size);
+  }
+
   DEBUGF("GKeyDecomp: Returning status %s in state %s\n",
          GKey_get_status_str(status),
          get_state_str(state));
 
   return status;
 }
+
+GKeyStatus gkeydecomp_decompress(GKeyDecomp *decomp, GKeyParameters *params)
+{
+  assert(decomp != NULL);
+  return decompress(decomp, params, get_out_limit(decomp));
+}
+
+static GKeyStatus vec_fn(void *context, GKeyParameters *params)
+{
+  const VecContext * const vc = context;
+  return decompress(vc->decomp, params, vc->out_limit);
+}
+
+GKeyStatus gkeydecomp_decompress_vec(GKeyDecomp        *decomp,
+                                     GKeyVecParameters *params)
+{
+  VecContext vc;
+
+  assert(decomp != NULL);
+
+  /* The budget applies to the whole call, not to each segment */
+  vc.decomp = decomp;
+  vc.out_limit = get_out_limit(decomp);
+  return GKeyStream_run_vec(vec_fn, &vc, params);
+}
+
+static GKeyStatus stream_fn(void *context, GKeyParameters *params)
+{
+  /* The budget doesn't apply to a whole stream */
+  return decompress(context, params, SIZE_MAX);
+}
+
+GKeyStatus gkeydecomp_stream(GKeyDecomp                 *decomp,
+                             const GKeyStreamParameters *params)
+{
+  assert(decomp != NULL);
+
+  /* A decompressor in caller-owned memory has no allocator */
+  return GKeyStream_run(stream_fn, decomp, params,
+                        decomp->allocator.alloc != NULL ?
+                        &decomp->allocator : NULL);
+}
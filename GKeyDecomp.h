@@ -23,11 +23,25 @@
 Dependencies: ANSI C library.
 History:
   CJB: 22-Nov-10: Created this header file.
+  CJB: 16-Oct-26: Added gkeydecomp_make_with_allocator().
+                  Added gkeydecomp_state_size() and gkeydecomp_init_in().
+                  Added gkeydecomp_pool_make(), gkeydecomp_pool_get() and
+                  gkeydecomp_pool_put().
+                  Added gkeydecomp_stream() and gkeydecomp_decompress_vec().
+                  Added gkeydecomp_set_progress().
+                  Added gkeydecomp_set_budget().
+                  Added gkeydecomp_set_checksum() and
+                  gkeydecomp_get_checksum().
+                  Added GKeyDecompStats and gkeydecomp_set_stats().
+                  Added gkeydecomp_set_trace().
 */
 
 #ifndef GKeyDecomp_h
 #define GKeyDecomp_h
 
+/* ISO library headers */
+#include <signal.h>
+
 /* Local headers */
 #include "GKey.h"
 
@@ -36,6 +50,18 @@ typedef struct GKeyDecomp GKeyDecomp;
     * Opaque definition of retained state for a decompressor.
     */
 
+typedef struct
+{
+  size_t literals;   /* No. of literal values decoded (one byte each) */
+  size_t copies;     /* No. of copy commands decoded */
+  size_t copy_bytes; /* Total size of the copy commands decoded */
+}
+GKeyDecompStats;
+   /*
+    * Statistics about the input decoded by a decompressor, collected if
+    * enabled by calling gkeydecomp_set_stats().
+    */
+
 GKeyDecomp *gkeydecomp_make(unsigned int history_log_2);
    /*
     * Creates a decompressor by allocating memory for, and initialising,
@@ -46,10 +72,47 @@ GKeyDecomp *gkeydecomp_make(unsigned int history_log_2);
     *          decompressor, otherwise NULL (not enough free memory).
     */
 
+GKeyDecomp *gkeydecomp_make_with_allocator(
+                          unsigned int         /*history_log_2*/,
+                          const GKeyAllocator */*allocator*/);
+   /*
+    * Creates a decompressor in the same way as gkeydecomp_make() except
+    * that memory is allocated (and later freed) using a specified allocator,
+    * which is copied. If 'allocator' is a null pointer then the allocator
+    * set by GKey_set_allocator() is used.
+    * Returns: If successful, a pointer to retained state for the new
+    *          decompressor, otherwise NULL (not enough free memory).
+    */
+
+size_t gkeydecomp_state_size(unsigned int /*history_log_2*/);
+   /*
+    * Gets the amount of memory required for a decompressor, including its
+    * internal buffers and data structures. The history_log_2 parameter is
+    * the no. of bytes to look behind, in base 2 logarithmic form.
+    * Returns: size of a decompressor in bytes.
+    */
+
+GKeyDecomp *gkeydecomp_init_in(void         */*buffer*/,
+                               size_t        /*size*/,
+                               unsigned int  /*history_log_2*/);
+   /*
+    * Creates a decompressor in a block of memory owned by the caller,
+    * such as static storage or a member of another struct, instead of
+    * allocating memory. The block at 'buffer' must be suitably aligned
+    * for any type of object, and 'size' must be at least the value
+    * returned by gkeydecomp_state_size() for the same history_log_2.
+    * The block must not be used for anything else until the decompressor
+    * is no longer needed.
+    * Returns: If successful, a pointer to retained state for the new
+    *          decompressor (equal to 'buffer'), otherwise NULL (size too
+    *          small).
+    */
+
 void gkeydecomp_destroy(GKeyDecomp */*decomp*/);
    /*
     * Frees memory that was previously allocated for a decompressor.
-    * Does nothing if called with a null pointer.
+    * Does nothing if called with a null pointer or a decompressor created
+    * by gkeydecomp_init_in().
     */
 
 void gkeydecomp_reset(GKeyDecomp */*decomp*/);
@@ -58,6 +121,110 @@ void gkeydecomp_reset(GKeyDecomp */*decomp*/);
     * stream of data (as though newly created).
     */
 
+GKeyPool *gkeydecomp_pool_make(unsigned int         /*history_log_2*/,
+                               size_t               /*max_free*/,
+                               const GKeyAllocator */*allocator*/,
+                               const GKeyPoolLock  */*lock*/);
+   /*
+    * Creates a pool of decompressors with the same history size, which
+    * are created on demand and reset for reuse instead of being destroyed.
+    * Up to 'max_free' decompressors are kept for reuse. Memory is allocated
+    * using a specified allocator, or the allocator set by
+    * GKey_set_allocator() if 'allocator' is a null pointer. A pool can
+    * only be shared between threads if 'lock' is not a null pointer; for
+    * the least contention, give each thread its own pool without a lock.
+    * Returns: If successful, a pointer to the new pool, otherwise NULL
+    *          (not enough free memory).
+    */
+
+GKeyDecomp *gkeydecomp_pool_get(GKeyPool */*pool*/);
+   /*
+    * Gets a decompressor from a pool created by gkeydecomp_pool_make(),
+    * either by resetting one that was returned to the pool or by creating
+    * a new one.
+    * Returns: If successful, a pointer to retained state for the
+    *          decompressor, otherwise NULL (not enough free memory).
+    */
+
+void gkeydecomp_pool_put(GKeyPool */*pool*/, GKeyDecomp */*decomp*/);
+   /*
+    * Returns a decompressor to the pool from which it was got, so that it
+    * can be reused. It is destroyed instead if the pool is full. Does
+    * nothing if called with a null pointer.
+    */
+
+void gkeydecomp_set_progress(GKeyDecomp            */*decomp*/,
+                             size_t                /*interval*/,
+                             volatile sig_atomic_t */*cancel*/);
+   /*
+    * Sets how often a decompressor reports progress and checks whether the
+    * operation should be cancelled. Progress is only reported (by calling
+    * the function specified in the parameters, if any) after at least
+    * 'interval' bytes have been consumed or output since it was last
+    * reported. If 'cancel' is not a null pointer then the object that it
+    * points to is read at the same times, and the operation is aborted if
+    * its value is non-zero; it may be set by a signal handler. Setting it
+    * from another thread relies on the platform making loads and stores of
+    * sig_atomic_t atomic and visible to other threads, which C99 doesn't
+    * guarantee. The settings persist when the decompressor is reset. The
+    * default is to report progress for every command, and not to check
+    * for cancellation.
+    */
+
+void gkeydecomp_set_budget(GKeyDecomp */*decomp*/, size_t /*budget*/);
+   /*
+    * Sets the maximum no. of bytes that a decompressor may output in one
+    * call to gkeydecomp_decompress() (or similar). Once the budget is used
+    * up, the call returns GKeyStatus_Suspended and decompression can be
+    * resumed by calling the function again with the updated parameters.
+    * This bounds the time taken by each call, e.g. to decompress data
+    * between frames of an animation. A 'budget' of 0 means unlimited, which
+    * is the default. The setting persists when the decompressor is reset.
+    * It has no effect on gkeydecomp_stream().
+    */
+
+void gkeydecomp_set_stats(GKeyDecomp      */*decomp*/,
+                          GKeyDecompStats */*stats*/);
+   /*
+    * Enables or disables collection of statistics by a decompressor. If
+    * 'stats' is not a null pointer then the object that it points to is
+    * zeroed, then updated by subsequent calls to decompress data (including
+    * after the decompressor is reset) until collection is disabled by
+    * passing a null pointer, which is the default. The object must remain
+    * valid until then.
+    */
+
+void gkeydecomp_set_trace(GKeyDecomp */*decomp*/, GKeyTrace */*trace*/);
+   /*
+    * Enables or disables recording of events by a decompressor, such as
+    * calls, state changes and the commands decoded. If 'trace' is not a
+    * null pointer then events are recorded in the ring that it points to,
+    * which may be shared with other compressors or decompressors (but not
+    * between threads). Passing a null pointer disables tracing, which is
+    * the default; tracing then costs almost nothing. The setting persists
+    * when the decompressor is reset.
+    */
+
+void gkeydecomp_set_checksum(GKeyDecomp */*decomp*/, bool /*checksum*/);
+   /*
+    * Enables or disables calculation of a CRC-32 of the output of a
+    * decompressor as it is produced, which avoids reading the output again
+    * to check its integrity. The algorithm is the same as that used by zlib
+    * and PNG. It also works when calculating the required output buffer
+    * size. The default is not to calculate a checksum. Should be called
+    * before any data is decompressed, or after a reset. The setting
+    * persists when the decompressor is reset.
+    */
+
+unsigned long gkeydecomp_get_checksum(const GKeyDecomp */*decomp*/);
+   /*
+    * Gets the CRC-32 of all data output by a decompressor since it was
+    * created or last reset, which must have been enabled by calling
+    * gkeydecomp_set_checksum(). At the end of the stream, this is the
+    * checksum of the whole of the decompressed data.
+    * Returns: a 32-bit CRC.
+    */
+
 GKeyStatus gkeydecomp_decompress(GKeyDecomp     */*decomp*/,
                                  GKeyParameters */*params*/);
    /*
@@ -72,4 +239,32 @@ GKeyStatus gkeydecomp_decompress(GKeyDecomp     */*decomp*/,
     * Returns: status of the decompressor (e.g. output buffer overflow).
     */
 
+GKeyStatus gkeydecomp_decompress_vec(GKeyDecomp        */*decomp*/,
+                                     GKeyVecParameters */*params*/);
+   /*
+    * Decompresses data in the same way as gkeydecomp_decompress() except
+    * that the input and output buffers are specified as arrays of segments
+    * by the 'params' object, which is updated to reflect the data consumed
+    * and output. Commands split between input segments are decoded as
+    * though the segments were contiguous. The output cannot be discarded
+    * to calculate its size.
+    * Returns: status of the decompressor (e.g. output buffer overflow if
+    *          all of the output segments are full, or suspended if the
+    *          work budget was used up).
+    */
+
+GKeyStatus gkeydecomp_stream(GKeyDecomp                 */*decomp*/,
+                             const GKeyStreamParameters */*params*/);
+   /*
+    * Decompresses a whole stream of data in one call, reading input and
+    * writing output in large chunks via the callback functions specified by
+    * the 'params' object, until the read function reports the end of the
+    * input. Two 32 KB buffers are allocated temporarily, using the
+    * decompressor's allocator.
+    * Returns: GKeyStatus_OK if successful, GKeyStatus_TruncatedInput if the
+    *          input ended in the middle of a command, GKeyStatus_Aborted if a
+    *          callback function returned false, or another status returned
+    *          by gkeydecomp_decompress() (e.g. BadInput).
+    */
+
 #endif
@@ -0,0 +1,189 @@
+/*
+ * GKeyLib: Pool of reusable objects
+ * Copyright (C) 2026 Christopher Bazley
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/* History:
+  CJB: 16-Oct-26: Created this source file.
+*/
+
+/* ISO library header files */
+#include <stddef.h>
+#include <stdbool.h>
+
+/* Local headers */
+#include "Internal/GKeyMisc.h"
+#include "Internal/GKeyAlloc.h"
+#include "Internal/GKeyPool.h"
+#include "GKey.h"
+
+struct GKeyPool
+{
+  const GKeyPoolType *type; /* Functions to create, reset and destroy
+                               objects */
+  char history_log_2;       /* History size of every object in the pool, as
+                               a base 2 logarithm */
+  GKeyAllocator allocator;  /* Used to allocate and free memory */
+  GKeyPoolLock lock;        /* Lock functions, or all null if not shared */
+  unsigned long hits;       /* No. of objects reused */
+  unsigned long misses;     /* No. of objects created */
+  size_t nfree;             /* No. of objects waiting to be reused */
+  size_t max_free;          /* Capacity of the 'free' array */
+  void *free[];             /* Objects waiting to be reused */
+};
+
+static void lock(GKeyPool *pool)
+{
+  if (pool->lock.lock != NULL)
+    pool->lock.lock(pool->lock.arg);
+}
+
+static void unlock(GKeyPool *pool)
+{
+  if (pool->lock.unlock != NULL)
+    pool->lock.unlock(pool->lock.arg);
+}
+
+GKeyPool *GKeyPool_make(const GKeyPoolType  *type,
+                        unsigned int         history_log_2,
+                        size_t               max_free,
+                        const GKeyAllocator *allocator,
+                        const GKeyPoolLock  *lock)
+{
+  GKeyPool *pool;
+
+  assert(type != NULL);
+  assert(lock == NULL || (lock->lock != NULL && lock->unlock != NULL));
+
+  pool = GKey_alloc(allocator, offsetof(GKeyPool, free) +
+                               sizeof(pool->free[0]) * max_free);
+  if (pool != NULL)
+  {
+    pool->type = type;
+    pool->history_log_2 = history_log_2;
+    GKey_get_allocator(&pool->allocator, allocator);
+    if (lock != NULL)
+    {
+      pool->lock = *lock;
+    }
+    else
+    {
+      pool->lock.lock = pool->lock.unlock = NULL;
+      pool->lock.arg = NULL;
+    }
+    pool->hits = pool->misses = 0;
+    pool->nfree = 0;
+    pool->max_free = max_free;
+    DEBUGF("GKeyPool: Made pool %p for up to %zu objects\n",
+           (void *)pool, max_free);
+  }
+
+  return pool;
+}
+
+void GKey_pool_destroy(GKeyPool *pool)
+{
+  if (pool != NULL)
+  {
+    /* Copy the allocator because it is part of the object to be freed */
+    const GKeyAllocator allocator = pool->allocator;
+
+    DEBUGF("GKeyPool: Destroying pool %p with %zu free objects\n",
+           (void *)pool, pool->nfree);
+
+    for (size_t i = 0; i < pool->nfree; ++i)
+      pool->type->destroy(pool->free[i]);
+
+    GKey_free(&allocator, pool);
+  }
+}
+
+void GKey_pool_get_stats(GKeyPool *pool, GKeyPoolStats *stats)
+{
+  assert(pool != NULL);
+  assert(stats != NULL);
+
+  lock(pool);
+  stats->hits = pool->hits;
+  stats->misses = pool->misses;
+  stats->nfree = pool->nfree;
+  unlock(pool);
+}
+
+void *GKeyPool_get(GKeyPool *pool, const GKeyPoolType *type)
+{
+  void *object = NULL;
+
+  assert(pool != NULL);
+  assert(pool->type == type);
+
+  lock(pool);
+  if (pool->nfree > 0)
+  {
+    object = pool->free[--pool->nfree];
+    ++pool->hits;
+  }
+  else
+  {
+    ++pool->misses;
+  }
+  unlock(pool);
+
+  /* Reset or create objects without holding the lock */
+  if (object != NULL)
+  {
+    DEBUG_VERBOSEF("GKeyPool: Reusing %p from pool %p\n",
+                   object, (void *)pool);
+    type->reset(object);
+  }
+  else
+  {
+    object = type->make(pool->history_log_2, &pool->allocator);
+    DEBUG_VERBOSEF("GKeyPool: Made %p for pool %p\n",
+                   object, (void *)pool);
+  }
+
+  return object;
+}
+
+void GKeyPool_put(GKeyPool           *pool,
+                  const GKeyPoolType *type,
+                  void               *object)
+{
+  bool kept = false;
+
+  assert(pool != NULL);
+  assert(pool->type == type);
+
+  if (object == NULL)
+    return;
+
+  lock(pool);
+  if (pool->nfree < pool->max_free)
+  {
+    pool->free[pool->nfree++] = object;
+    kept = true;
+  }
+  unlock(pool);
+
+  if (!kept)
+  {
+    DEBUG_VERBOSEF("GKeyPool: Pool %p is full so destroying %p\n",
+                   (void *)pool, object);
+    type->destroy(object);
+  }
+}
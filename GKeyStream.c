@@ -0,0 +1,231 @@
+/*
+ * GKeyLib: Callback streaming
+ * Copyright (C) 2026 Christopher Bazley
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/* History:
+  CJB: 16-Oct-26: Created this source file.
+*/
+
+/* ISO library header files */
+#include <stddef.h>
+#include <stdbool.h>
+
+/* Local headers */
+#include "Internal/GKeyMisc.h"
+#include "Internal/GKeyAlloc.h"
+#include "Internal/GKeyStream.h"
+#include "GKey.h"
+
+static bool write_output(const GKeyStreamParameters *sparams,
+                         GKeyParameters             *params,
+                         unsigned char              *out)
+{
+  const size_t n = GKeyStreamBufferSize - params->out_size;
+  bool success = true;
+
+  if (n > 0)
+  {
+    DEBUG_VERBOSEF("GKeyStream: Writing %zu bytes\n", n);
+    success = sparams->write_cb(sparams->cb_arg, out, n);
+    params->out_buffer = out;
+    params->out_size = GKeyStreamBufferSize;
+  }
+
+  return success;
+}
+
+static void skip_used(GKeyVecParameters *params)
+{
+  /* Skip any input segments that have been wholly consumed */
+  while (params->in_count > 0 && params->in_offset >= params->in_vec->size)
+  {
+    ++params->in_vec;
+    --params->in_count;
+    params->in_offset = 0;
+  }
+
+  /* Skip any output segments that have been filled */
+  while (params->out_count > 0 &&
+         params->out_offset >= params->out_vec->size)
+  {
+    ++params->out_vec;
+    --params->out_count;
+    params->out_offset = 0;
+  }
+}
+
+GKeyStatus GKeyStream_run_vec(GKeyStreamFn      *fn,
+                              void              *context,
+                              GKeyVecParameters *vparams)
+{
+  GKeyStatus status = GKeyStatus_OK;
+  GKeyParameters params;
+  bool flush;
+  char empty; /* never accessed */
+
+  assert(fn != NULL);
+  assert(vparams != NULL);
+  assert(vparams->in_vec != NULL || vparams->in_count == 0);
+  assert(vparams->out_vec != NULL || vparams->out_count == 0);
+
+  params.prog_cb = vparams->prog_cb;
+  params.cb_arg = vparams->cb_arg;
+
+  /* A call with no input has a special meaning (e.g. flush the output of
+     a compressor) so don't make one just because all input was consumed */
+  skip_used(vparams);
+  flush = (vparams->in_count == 0);
+
+  for (;;)
+  {
+    size_t in_size, out_size;
+
+    if (vparams->in_count > 0)
+    {
+      params.in_buffer = (const char *)vparams->in_vec->base +
+                         vparams->in_offset;
+      in_size = vparams->in_vec->size - vparams->in_offset;
+    }
+    else
+    {
+      params.in_buffer = &empty;
+      in_size = 0;
+    }
+    params.in_size = in_size;
+
+    /* A null output buffer would mean something else */
+    if (vparams->out_count > 0)
+    {
+      params.out_buffer = (char *)vparams->out_vec->base +
+                          vparams->out_offset;
+      out_size = vparams->out_vec->size - vparams->out_offset;
+    }
+    else
+    {
+      params.out_buffer = &empty;
+      out_size = 0;
+    }
+    params.out_size = out_size;
+
+    DEBUG_VERBOSEF("GKeyStream: Processing %zu bytes into %zu bytes\n",
+                   in_size, out_size);
+
+    status = fn(context, &params);
+
+    vparams->in_offset += in_size - params.in_size;
+    vparams->out_offset += out_size - params.out_size;
+    skip_used(vparams);
+
+    if (status == GKeyStatus_BufferOverflow)
+    {
+      /* Continue with the next output segment, if any */
+      if (vparams->out_count == 0 || out_size == 0)
+        break;
+    }
+    else if (status == GKeyStatus_OK || status == GKeyStatus_TruncatedInput)
+    {
+      /* Continue with the next input segment, if any */
+      if (flush || vparams->in_count == 0)
+        break;
+    }
+    else
+    {
+      break;
+    }
+  }
+
+  DEBUGF("GKeyStream: Returning status %s\n", GKey_get_status_str(status));
+  return status;
+}
+
+GKeyStatus GKeyStream_run(GKeyStreamFn               *fn,
+                          void                       *context,
+                          const GKeyStreamParameters *sparams,
+                          const GKeyAllocator        *allocator)
+{
+  GKeyStatus status = GKeyStatus_OK;
+  unsigned char *in, *out;
+  GKeyParameters params;
+  bool eof = false;
+
+  assert(fn != NULL);
+  assert(sparams != NULL);
+  assert(sparams->read_cb != NULL);
+  assert(sparams->write_cb != NULL);
+
+  in = GKey_alloc(allocator, GKeyStreamBufferSize * 2);
+  if (in == NULL)
+    return GKeyStatus_NoMem;
+
+  out = in + GKeyStreamBufferSize;
+
+  params.in_buffer = in;
+  params.in_size = 0;
+  params.out_buffer = out;
+  params.out_size = GKeyStreamBufferSize;
+  params.prog_cb = sparams->prog_cb;
+  params.cb_arg = sparams->cb_arg;
+
+  for (;;)
+  {
+    if (params.in_size == 0 && !eof)
+    {
+      size_t n = 0;
+      if (!sparams->read_cb(sparams->cb_arg, in, GKeyStreamBufferSize, &n))
+      {
+        status = GKeyStatus_Aborted;
+        break;
+      }
+      assert(n <= GKeyStreamBufferSize);
+      DEBUG_VERBOSEF("GKeyStream: Read %zu bytes\n", n);
+      eof = (n == 0);
+      params.in_buffer = in;
+      params.in_size = n;
+    }
+
+    /* Process as much input as possible in one call. At the end of the
+       input, this is called with none so that pending output is flushed. */
+    status = fn(context, &params);
+
+    if (status == GKeyStatus_BufferOverflow)
+    {
+      if (!write_output(sparams, &params, out))
+      {
+        status = GKeyStatus_Aborted;
+        break;
+      }
+      continue; /* process the rest of the input */
+    }
+
+    /* A decompressor needs more input to finish the current command */
+    if (status == GKeyStatus_TruncatedInput && !eof)
+      status = GKeyStatus_OK;
+
+    if (status != GKeyStatus_OK || eof)
+      break;
+  }
+
+  /* Write any output produced before the end of input or an error */
+  if (status != GKeyStatus_Aborted && !write_output(sparams, &params, out))
+    status = GKeyStatus_Aborted;
+
+  GKey_free(allocator, in);
+
+  DEBUGF("GKeyStream: Returning status %s\n", GKey_get_status_str(status));
+  return status;
+}
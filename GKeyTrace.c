@@ -0,0 +1,145 @@
+/*
+ * GKeyLib: Event tracing
+ * Copyright (C) 2026 Christopher Bazley
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/* History:
+  CJB: 16-Oct-26: Created this source file.
+*/
+
+/* ISO library header files */
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <limits.h>
+
+/* Local headers */
+#include "Internal/GKeyMisc.h"
+#include "Internal/GKeyTrace.h"
+#include "GKey.h"
+
+enum
+{
+  HeaderSize = 16, /* No. of bytes in the header of a saved trace */
+  EventSize = 16,  /* No. of bytes per event in a saved trace */
+  TraceVersion = 1, /* Version of the format of a saved trace */
+  EventsPerWrite = 64 /* No. of events passed to each call of the write
+                         function */
+};
+
+static unsigned char *put_word(unsigned char *p, uint32_t word)
+{
+  /* Little-endian, regardless of the host */
+  for (size_t i = 0; i < sizeof(uint32_t); ++i)
+  {
+    p[i] = (unsigned char)(word & 0xff);
+    word >>= 8;
+  }
+  return p + sizeof(uint32_t);
+}
+
+void GKey_trace_init(GKeyTrace      *trace,
+                     GKeyTraceEvent *events,
+                     size_t          size)
+{
+  assert(trace != NULL);
+  assert(events != NULL);
+  assert(size > 0);
+  assert((size & (size - 1)) == 0);
+
+  trace->events = events;
+  trace->size = size;
+  trace->count = 0;
+}
+
+void GKeyTrace_record(GKeyTrace       *trace,
+                      GKeyTraceSource  source,
+                      GKeyTraceType    type,
+                      int              state,
+                      size_t           pos,
+                      size_t           arg1,
+                      size_t           arg2)
+{
+  GKeyTraceEvent *event;
+
+  assert(trace != NULL);
+  assert(trace->events != NULL);
+  assert(state >= SCHAR_MIN && state <= SCHAR_MAX);
+
+  event = &trace->events[trace->count++ & (trace->size - 1)];
+  event->type = (unsigned char)type;
+  event->source = (unsigned char)source;
+  event->state = (signed char)state;
+  event->pos = (uint32_t)(pos & 0xffffffffu);
+  event->arg1 = (uint32_t)(arg1 & 0xffffffffu);
+  event->arg2 = (uint32_t)(arg2 & 0xffffffffu);
+}
+
+bool GKey_trace_save(const GKeyTrace *trace,
+                     GKeyWriteFn     *write_cb,
+                     void            *cb_arg)
+{
+  unsigned char buffer[EventSize * EventsPerWrite], *p;
+  size_t first, n;
+
+  assert(trace != NULL);
+  assert(write_cb != NULL);
+
+  /* Only the most recent events are still in the ring */
+  n = LOWEST(trace->count, trace->size);
+  first = trace->count - n;
+
+  DEBUGF("GKeyTrace: Saving %zu of %zu events\n", n, trace->count);
+
+  p = buffer;
+  *p++ = 'G';
+  *p++ = 'K';
+  *p++ = 'T';
+  *p++ = 'R';
+  *p++ = TraceVersion;
+  *p++ = EventSize;
+  *p++ = 0;
+  *p++ = 0;
+  p = put_word(p, (uint32_t)n);
+  p = put_word(p, (uint32_t)(first & 0xffffffffu)); /* no. overwritten */
+  assert(p == buffer + HeaderSize);
+
+  if (!write_cb(cb_arg, buffer, HeaderSize))
+    return false;
+
+  for (size_t i = 0; i < n; )
+  {
+    for (p = buffer; i < n && p < buffer + sizeof(buffer); ++i)
+    {
+      const GKeyTraceEvent * const event =
+        &trace->events[(first + i) & (trace->size - 1)];
+
+      *p++ = event->type;
+      *p++ = event->source;
+      *p++ = (unsigned char)event->state;
+      *p++ = 0;
+      p = put_word(p, event->pos);
+      p = put_word(p, event->arg1);
+      p = put_word(p, event->arg2);
+    }
+
+    if (!write_cb(cb_arg, buffer, (size_t)(p - buffer)))
+      return false;
+  }
+
+  return true;
+}
@@ -0,0 +1,66 @@
+/*
+ * GKeyLib: Memory allocation
+ * Copyright (C) 2026 Christopher Bazley
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/* GKeyAlloc.h declares functions used internally to allocate and free
+   memory via a client-supplied allocator or the default allocator.
+
+Dependencies: ANSI C library.
+History:
+  CJB: 16-Oct-26: Created this header file.
+*/
+
+#ifndef GKeyAlloc_h
+#define GKeyAlloc_h
+
+/* ISO library header files */
+#include <stddef.h>
+
+/* Local headers */
+#include "../GKey.h"
+
+void GKey_get_allocator(GKeyAllocator       */*out*/,
+                        const GKeyAllocator */*allocator*/);
+   /*
+    * Gets a copy of the allocator to be used by a new object, which is the
+    * one pointed to by 'allocator' unless that is a null pointer, in which
+    * case it is the default allocator.
+    */
+
+void *GKey_alloc(const GKeyAllocator */*allocator*/, size_t /*size*/);
+   /*
+    * Allocates 'size' bytes using a specified allocator, or the default
+    * allocator if 'allocator' is a null pointer.
+    * Returns: address of the allocated memory, or NULL if not enough memory.
+    */
+
+void GKey_free(const GKeyAllocator */*allocator*/, void */*ptr*/);
+   /*
+    * Frees memory previously allocated by GKey_alloc using the same
+    * allocator. Does nothing if called with a null pointer.
+    */
+
+size_t GKey_align_size(size_t /*size*/);
+   /*
+    * Rounds up a size so that an object of any type used by this library
+    * could be placed immediately after an object of that size within a
+    * suitably-aligned block of memory.
+    * Returns: the rounded size in bytes.
+    */
+
+#endif
@@ -0,0 +1,44 @@
+/*
+ * GKeyLib: Cyclic redundancy check
+ * Copyright (C) 2026 Christopher Bazley
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/* GKeyCRC.h declares a function used internally to calculate the CRC-32
+   of data, as used by zlib, PNG and many other formats.
+
+Dependencies: ANSI C library.
+History:
+  CJB: 16-Oct-26: Created this header file.
+*/
+
+#ifndef GKeyCRC_h
+#define GKeyCRC_h
+
+/* ISO library header files */
+#include <stddef.h>
+
+unsigned long GKey_crc32(unsigned long /*crc*/, const void */*s*/,
+                         size_t /*n*/);
+   /*
+    * Updates a CRC-32 (polynomial 0x04C11DB7, reflected, with the initial
+    * value and final result inverted) to include 'n' bytes at address 's'.
+    * The 'crc' argument is the result of a previous call or 0 to start a
+    * new calculation.
+    * Returns: the updated CRC-32 of all data so far.
+    */
+
+#endif /* GKeyCRC_h */
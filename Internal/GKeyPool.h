@@ -0,0 +1,88 @@
+/*
+ * GKeyLib: Pool of reusable objects
+ * Copyright (C) 2026 Christopher Bazley
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/* GKeyPool.h declares functions used internally to manage a pool of
+   compressors or decompressors, which are created on demand and reset
+   instead of being destroyed.
+
+Dependencies: ANSI C library.
+History:
+  CJB: 16-Oct-26: Created this header file.
+*/
+
+#ifndef GKeyPool_h
+#define GKeyPool_h
+
+/* ISO library header files */
+#include <stddef.h>
+
+/* Local headers */
+#include "../GKey.h"
+
+typedef void *GKeyPoolMakeFn(unsigned int         /*history_log_2*/,
+                             const GKeyAllocator */*allocator*/);
+   /*
+    * Type of function called to create an object for a pool.
+    * Returns: a pointer to the new object, or NULL if not enough memory.
+    */
+
+typedef void GKeyPoolObjectFn(void */*object*/);
+   /*
+    * Type of function called to reset or destroy an object in a pool.
+    */
+
+typedef struct
+{
+  GKeyPoolMakeFn   *make;    /* Function to create an object */
+  GKeyPoolObjectFn *reset;   /* Function to reset an object for reuse */
+  GKeyPoolObjectFn *destroy; /* Function to destroy an object */
+}
+GKeyPoolType;
+
+GKeyPool *GKeyPool_make(const GKeyPoolType  */*type*/,
+                        unsigned int         /*history_log_2*/,
+                        size_t               /*max_free*/,
+                        const GKeyAllocator */*allocator*/,
+                        const GKeyPoolLock  */*lock*/);
+   /*
+    * Creates a pool of objects of a given type, each with the same
+    * history size. No more than 'max_free' objects are kept for reuse.
+    * The pool and its objects are allocated using a specified allocator,
+    * or the default allocator if 'allocator' is a null pointer. If 'lock'
+    * is a null pointer then the pool must not be shared between threads.
+    * Returns: a pointer to the new pool, or NULL if not enough memory.
+    */
+
+void *GKeyPool_get(GKeyPool */*pool*/, const GKeyPoolType */*type*/);
+   /*
+    * Gets an object from a pool, which must be of the given type. An object
+    * waiting to be reused is reset, otherwise a new object is created.
+    * Returns: a pointer to the object, or NULL if not enough memory.
+    */
+
+void GKeyPool_put(GKeyPool           */*pool*/,
+                  const GKeyPoolType */*type*/,
+                  void               */*object*/);
+   /*
+    * Returns an object previously got from a pool of the given type. It is
+    * destroyed instead if the pool already holds as many objects as it can.
+    * Does nothing if called with a null pointer.
+    */
+
+#endif
@@ -0,0 +1,59 @@
+/*
+ * GKeyLib: Static tracepoints
+ * Copyright (C) 2026 Christopher Bazley
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/* GKeyProbes.h defines macros used internally to place static tracepoints
+   in the compressor and decompressor. If GKEY_USDT is defined then each
+   macro expands to a user-level statically defined tracing (USDT) probe
+   in provider 'gkeylib', using <sys/sdt.h> from SystemTap. Such probes
+   cost a single no-op instruction until attached to by a tool such as
+   perf or bpftrace. Otherwise, the macros expand to nothing and their
+   arguments are not evaluated.
+
+Dependencies: ANSI C library, <sys/sdt.h> (if GKEY_USDT is defined).
+History:
+  CJB: 16-Oct-26: Created this header file.
+*/
+
+#ifndef GKeyProbes_h
+#define GKeyProbes_h
+
+#ifdef GKEY_USDT
+
+#include <sys/sdt.h>
+
+#define GKEY_PROBE2(name, a, b) \
+  DTRACE_PROBE2(gkeylib, name, a, b)
+
+#define GKEY_PROBE3(name, a, b, c) \
+  DTRACE_PROBE3(gkeylib, name, a, b, c)
+
+#define GKEY_PROBE4(name, a, b, c, d) \
+  DTRACE_PROBE4(gkeylib, name, a, b, c, d)
+
+#else /* GKEY_USDT */
+
+#define GKEY_PROBE2(name, a, b) ((void)0)
+
+#define GKEY_PROBE3(name, a, b, c) ((void)0)
+
+#define GKEY_PROBE4(name, a, b, c, d) ((void)0)
+
+#endif /* GKEY_USDT */
+
+#endif /* GKeyProbes_h */
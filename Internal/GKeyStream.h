@@ -0,0 +1,77 @@
+/*
+ * GKeyLib: Callback streaming
+ * Copyright (C) 2026 Christopher Bazley
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/* GKeyStream.h declares functions used internally to drive a compressor
+   or decompressor using callbacks to read input and write output, or
+   arrays of input and output buffer segments.
+
+Dependencies: ANSI C library.
+History:
+  CJB: 16-Oct-26: Created this header file.
+*/
+
+#ifndef GKeyStream_h
+#define GKeyStream_h
+
+/* Local headers */
+#include "../GKey.h"
+
+enum
+{
+  GKeyStreamBufferSize = 32768 /* Size of each of the input and output
+                                  buffers, in bytes */
+};
+
+typedef GKeyStatus GKeyStreamFn(void           */*context*/,
+                                GKeyParameters */*params*/);
+   /*
+    * Type of function called to compress or decompress data from an input
+    * buffer to an output buffer, such as gkeycomp_compress or
+    * gkeydecomp_decompress.
+    */
+
+GKeyStatus GKeyStream_run(GKeyStreamFn               */*fn*/,
+                          void                       */*context*/,
+                          const GKeyStreamParameters */*params*/,
+                          const GKeyAllocator        */*allocator*/);
+   /*
+    * Repeatedly reads input into a buffer, calls a specified function to
+    * process it, and writes the output from another buffer, until the end
+    * of the input. The function is called with no input at the end to
+    * allow it to flush any pending output. The buffers are allocated using
+    * a specified allocator, or the default allocator if 'allocator' is a
+    * null pointer.
+    * Returns: GKeyStatus_Aborted if a callback failed, otherwise the status
+    *          returned by the last call to 'fn' (except TruncatedInput if
+    *          more input was read afterwards).
+    */
+
+GKeyStatus GKeyStream_run_vec(GKeyStreamFn      */*fn*/,
+                              void              */*context*/,
+                              GKeyVecParameters */*params*/);
+   /*
+    * Calls a specified function to process each input segment in turn,
+    * writing output to each output segment in turn, until all of the input
+    * has been consumed or all of the output segments are full. The
+    * function is only called with no input if there was none to begin
+    * with. No data is copied.
+    * Returns: the status returned by the last call to 'fn'.
+    */
+
+#endif
@@ -0,0 +1,51 @@
+/*
+ * GKeyLib: Event tracing
+ * Copyright (C) 2026 Christopher Bazley
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/* GKeyTrace.h declares a function used internally to record events in a
+   ring set up by GKey_trace_init.
+
+Dependencies: ANSI C library.
+History:
+  CJB: 16-Oct-26: Created this header file.
+*/
+
+#ifndef GKeyTrace_h
+#define GKeyTrace_h
+
+/* ISO library header files */
+#include <stddef.h>
+
+/* Local headers */
+#include "../GKey.h"
+
+void GKeyTrace_record(GKeyTrace       */*trace*/,
+                      GKeyTraceSource  /*source*/,
+                      GKeyTraceType    /*type*/,
+                      int              /*state*/,
+                      size_t           /*pos*/,
+                      size_t           /*arg1*/,
+                      size_t           /*arg2*/);
+   /*
+    * Records an event in a specified ring, overwriting the oldest event if
+    * the ring is full. Callers should check whether tracing is enabled
+    * before calling this function, so that tracing costs almost nothing
+    * when disabled.
+    */
+
+#endif /* GKeyTrace_h */
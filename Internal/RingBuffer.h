@@ -35,6 +35,14 @@ History:
                   and another to deallocate a buffer. These were needed
                   because it isn't strictly legal to embed a struct with a
                   flexible array member in another struct.
+  CJB: 16-Oct-26: Added functions to find the length of the common prefix of
+                  two strings within a ring buffer, or of a string within a
+                  ring buffer and another string.
+                  Characters not written since the ring buffer was reset are
+                  no longer cleared, so RingBuffer_reset takes constant
+                  time. Added RingBuffer_get_chars.
+                  RingBuffer_make and RingBuffer_destroy take an allocator.
+                  Added RingBuffer_state_size.
 */
 
 #ifndef RingBuffer_h
@@ -44,11 +52,17 @@ History:
 #include <stddef.h>
 #include <stdbool.h>
 
+/* Local headers */
+#include "../GKey.h"
+
 typedef struct
 {
   size_t size;             /* Size of ring buffer in bytes */
   size_t write_pos;        /* Position in buffer at which to write data */
-  bool filled;             /* Has the write position wrapped around yet? */
+  bool filled;             /* Has the write position wrapped around yet? If
+                              not then the content from the write position
+                              to the end of the buffer is treated as zeros
+                              regardless of what is stored there. */
   char size_log_2;         /* Size of ring buffer in base 2 logarithmic form */
   unsigned char buffer[];  /* Ring buffer is a variable-length array */
 }
@@ -65,25 +79,40 @@ typedef size_t RingBufferWriteFn(void       */*arg*/,
     * Returns: number of bytes to be copied.
     */
 
-RingBuffer *RingBuffer_make(unsigned int /*size_log_2*/);
+RingBuffer *RingBuffer_make(unsigned int               /*size_log_2*/,
+                            const GKeyAllocator */*allocator*/);
    /*
     * Allocates and initializes a ring buffer of a given size,
-    * specified as a power of 2.
+    * specified as a power of 2. Memory is allocated using a specified
+    * allocator, or the default allocator if 'allocator' is a null pointer.
     */
 
-void RingBuffer_destroy(RingBuffer */*ring*/);
+void RingBuffer_destroy(RingBuffer          */*ring*/,
+                        const GKeyAllocator */*allocator*/);
    /*
-    * Deallocates a specified ring buffer.
+    * Deallocates a specified ring buffer using the same allocator as
+    * was used to create it.
+    */
+
+size_t RingBuffer_state_size(unsigned int /*size_log_2*/);
+   /*
+    * Gets the amount of memory required for a ring buffer of a given size,
+    * specified as a power of 2.
+    * Returns: size of a ring buffer object in bytes.
     */
 
 void RingBuffer_init(RingBuffer */*ring*/, unsigned int /*size_log_2*/);
    /*
     * Initialises a ring buffer of a given size, specified as a power of 2.
+    * The memory at 'ring' must be at least as big as the value returned by
+    * RingBuffer_state_size for the same size.
     */
 
 void RingBuffer_reset(RingBuffer */*ring*/);
    /*
-    * Resets a specified ring buffer to its initial state.
+    * Resets a specified ring buffer to its initial state, in which every
+    * character reads as zero. Nothing is cleared, so this takes constant
+    * time regardless of the buffer size.
     */
 
 void RingBuffer_write(RingBuffer */*ring*/, const void */*s*/, size_t /*n*/);
@@ -112,6 +141,21 @@ size_t RingBuffer_copy(RingBuffer        */*ring*/,
     * Returns: the number of characters copied.
     */
 
+const void *RingBuffer_get_chars(const RingBuffer */*ring*/,
+                                 size_t            /*offset*/,
+                                 size_t           */*n*/);
+   /*
+    * Gets the address of a contiguous range of characters at 'offset' beyond
+    * the current write position in a specified ring buffer. On entry, the
+    * object pointed to by 'n' is the maximum number of characters required;
+    * on exit, it is the number available at the returned address, which is
+    * only less than requested if the range is split by the end of the buffer
+    * or by the boundary between written and unwritten characters. The
+    * latter are represented by a block of zeros outside the buffer.
+    * Behaviour is undefined if offset+n is greater than the buffer size.
+    * Returns: the address of the first character.
+    */
+
 int RingBuffer_read_char(const RingBuffer */*ring*/, size_t /*offset*/);
    /*
     * Reads a character from 'offset' characters beyond the current write
@@ -146,4 +190,31 @@ int RingBuffer_compare(const RingBuffer */*ring*/,
     *          to whether the string at 'offset_1' is greater than, equal
     *          to, or less than the string at 'offset_2'.
     */
+
+size_t RingBuffer_mismatch(const RingBuffer */*ring*/,
+                           size_t            /*offset1*/,
+                           size_t            /*offset2*/,
+                           size_t            /*n*/);
+   /*
+    * Compares the first 'n' characters at 'offset1' beyond the current write
+    * position in a specified ring buffer with the first 'n' characters at
+    * 'offset2' beyond the current write position, several characters at a
+    * time. Behaviour is undefined if offset1+n or offset2+n is greater than
+    * the buffer size.
+    * Returns: the number of characters before the first mismatch, or 'n'
+    *          if the strings are equal.
+    */
+
+size_t RingBuffer_match(const RingBuffer */*ring*/,
+                        size_t            /*offset*/,
+                        const void       */*s*/,
+                        size_t            /*n*/);
+   /*
+    * Compares the first 'n' characters at 'offset' beyond the current write
+    * position in a specified ring buffer with the first 'n' characters of
+    * the object pointed to by 's', several characters at a time. Behaviour
+    * is undefined if offset+n is greater than the buffer size.
+    * Returns: the number of characters before the first mismatch, or 'n'
+    *          if the strings are equal.
+    */
 #endif
@@ -0,0 +1,146 @@
+/*
+ * GKeyLib: Ring buffer hash chains
+ * Copyright (C) 2026 Christopher Bazley
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/* RingHash.h provides hash chains which link together the positions in a
+   large ring buffer of sequences that begin with the same few characters,
+   most recent first. Each position is recorded as a 32-bit count of the
+   characters written to the ring buffer, so that the chains can be emptied
+   without clearing them.
+
+Dependencies: ANSI C library.
+History:
+  CJB: 16-Oct-26: Created this header file.
+*/
+
+#ifndef RingHash_h
+#define RingHash_h
+
+/* ISO library header files */
+#include <stddef.h>
+#include <stdint.h>
+
+/* Local headers */
+#include "../GKey.h"
+#include "RingBuffer.h"
+
+enum
+{
+  RingHashMinSize = 4,      /* No. of characters hashed at each position */
+  RingHashHeadsLog2 = 16,   /* No. of hash chains, as a base 2 logarithm */
+  RingHashMaxChainLog2 = 20 /* Maximum no. of positions that can be in the
+                               hash chains, as a base 2 logarithm. Older
+                               positions are forgotten. */
+};
+
+typedef struct
+{
+  uint32_t pos;       /* Count of characters written to the ring buffer */
+  uint32_t base;      /* Value of 'pos' when the hash chains were emptied */
+  uint32_t hashed;    /* Count of characters whose positions are in the
+                         hash chains */
+  size_t size;        /* Size of the ring buffer in bytes */
+  size_t limit;       /* Maximum distance back from 'pos' of any position in
+                         the hash chains */
+  size_t chain_mask;  /* No. of entries in 'chain' minus 1 */
+  uint32_t *chain;    /* Positions of previous sequences with the same hash,
+                         indexed by the low bits of position */
+  uint32_t heads[];   /* Position of the most recent sequence for each hash
+                         value, followed by 'chain' */
+}
+RingHash;
+
+RingHash *RingHash_make(unsigned int         /*size_log_2*/,
+                        const GKeyAllocator */*allocator*/);
+   /*
+    * Allocates and initializes hash chains for a ring buffer of a given size,
+    * specified as a power of 2. Memory is allocated using a specified
+    * allocator, or the default allocator if 'allocator' is a null pointer.
+    * Returns: a pointer to the new hash chains, or NULL if not enough memory.
+    */
+
+void RingHash_destroy(RingHash            */*hash*/,
+                      const GKeyAllocator */*allocator*/);
+   /*
+    * Deallocates specified hash chains using the same allocator as was
+    * used to create them.
+    */
+
+size_t RingHash_state_size(unsigned int /*size_log_2*/);
+   /*
+    * Gets the amount of memory required for hash chains for a ring buffer of
+    * a given size, specified as a power of 2.
+    * Returns: size of a hash chains object in bytes.
+    */
+
+void RingHash_init(RingHash */*hash*/, unsigned int /*size_log_2*/);
+   /*
+    * Initializes hash chains for a ring buffer of a given size, specified as
+    * a power of 2, in memory at least as big as the value returned by
+    * RingHash_state_size for the same size.
+    */
+
+void RingHash_reset(RingHash */*hash*/);
+   /*
+    * Empties specified hash chains to match the initial state of a ring
+    * buffer. Nothing is cleared, so this takes constant time.
+    */
+
+void RingHash_rebuild(RingHash         */*hash*/,
+                      const RingBuffer */*ring*/,
+                      size_t            /*n*/);
+   /*
+    * Rebuilds specified hash chains to match the content of a ring buffer,
+    * of which only the last 'n' characters written are inserted. This
+    * takes time proportional to 'n'.
+    */
+
+void RingHash_add(RingHash         */*hash*/,
+                  const RingBuffer */*ring*/,
+                  size_t            /*n*/);
+   /*
+    * Records that 'n' characters were written to a specified ring buffer,
+    * and adds the position of every sequence of RingHashMinSize characters
+    * now complete to the hash chains. This must be done after the
+    * characters have been written.
+    */
+
+size_t RingHash_first(const RingHash   */*hash*/,
+                      const RingBuffer */*ring*/,
+                      const void       */*s*/);
+   /*
+    * Finds the most recent sequence in a specified ring buffer which may
+    * begin with the first RingHashMinSize characters of the string pointed
+    * to by 's'. Sequences found are not guaranteed to match, but are never
+    * the most recently written RingHashMinSize - 1 characters.
+    * Returns: offset from the write position of the start of the sequence,
+    *          or SIZE_MAX if not found.
+    */
+
+size_t RingHash_next(const RingHash   */*hash*/,
+                     const RingBuffer */*ring*/,
+                     size_t            /*offset*/);
+   /*
+    * Finds the next most recent sequence after the one found at 'offset'
+    * which may begin with the same characters. The ring buffer must not be
+    * written to between calls that continue the same search.
+    * Returns: offset from the write position of the start of the sequence,
+    *          or SIZE_MAX if not found.
+    */
+
+#endif
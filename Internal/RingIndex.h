@@ -0,0 +1,153 @@
+/*
+ * GKeyLib: Ring buffer character index
+ * Copyright (C) 2026 Christopher Bazley
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/* RingIndex.h provides an index of the positions of every character value
+   within a small ring buffer, and a bit-parallel (shift-and) search for the
+   longest sequence in the ring buffer matching a string of characters.
+
+Dependencies: ANSI C library.
+History:
+  CJB: 16-Oct-26: Created this header file.
+*/
+
+#ifndef RingIndex_h
+#define RingIndex_h
+
+/* ISO library header files */
+#include <stddef.h>
+#include <stdbool.h>
+
+/* Local headers */
+#include "../GKey.h"
+#include "RingBuffer.h"
+
+enum
+{
+  RingIndexMaxSizeLog2 = 9 /* Largest ring buffer that can be indexed, as a
+                              base 2 logarithm. Each index requires
+                              (UCHAR_MAX + 2) bits per ring buffer byte. */
+};
+
+typedef struct
+{
+  size_t size;            /* Size of the indexed ring buffer in bytes */
+  size_t nwords;          /* No. of words in each bit vector */
+  unsigned long *ends;    /* Positions of the last character of each
+                             sequence matched so far */
+  unsigned long vectors[]; /* One bit vector per character value, in which
+                              bit n is set if that value is at position n
+                              of the ring buffer, followed by 'ends' */
+}
+RingIndex;
+
+RingIndex *RingIndex_make(unsigned int         /*size_log_2*/,
+                          const GKeyAllocator */*allocator*/);
+   /*
+    * Allocates and initializes an index for a ring buffer of a given size,
+    * specified as a power of 2 which must not exceed RingIndexMaxSizeLog2.
+    * Memory is allocated using a specified allocator, or the default
+    * allocator if 'allocator' is a null pointer.
+    * Returns: a pointer to the new index, or NULL if not enough memory.
+    */
+
+void RingIndex_destroy(RingIndex           */*index*/,
+                       const GKeyAllocator */*allocator*/);
+   /*
+    * Deallocates a specified ring buffer index using the same allocator
+    * as was used to create it.
+    */
+
+size_t RingIndex_state_size(unsigned int /*size_log_2*/);
+   /*
+    * Gets the amount of memory required for an index of a ring buffer of a
+    * given size, specified as a power of 2 which must not exceed
+    * RingIndexMaxSizeLog2.
+    * Returns: size of an index object in bytes.
+    */
+
+void RingIndex_init(RingIndex */*index*/, unsigned int /*size_log_2*/);
+   /*
+    * Initializes an index for a ring buffer of a given size, specified as a
+    * power of 2, in memory at least as big as the value returned by
+    * RingIndex_state_size for the same size.
+    */
+
+void RingIndex_reset(RingIndex */*index*/);
+   /*
+    * Resets a specified index to match the initial state of a ring buffer
+    * (i.e. all characters are nul).
+    */
+
+void RingIndex_rebuild(RingIndex        */*index*/,
+                       const RingBuffer */*ring*/);
+   /*
+    * Rebuilds a specified index to match the current content of a ring
+    * buffer, discarding any search in progress. This takes time
+    * proportional to the size of the ring buffer.
+    */
+
+void RingIndex_remove(RingIndex        */*index*/,
+                      const RingBuffer */*ring*/,
+                      size_t            /*offset*/,
+                      size_t            /*n*/);
+   /*
+    * Removes the 'n' characters at 'offset' beyond the current write
+    * position of a specified ring buffer from its index. This must be done
+    * before those characters are overwritten. Behaviour is undefined if
+    * offset+n is greater than the buffer size.
+    */
+
+void RingIndex_add(RingIndex        */*index*/,
+                   const RingBuffer */*ring*/,
+                   size_t            /*offset*/,
+                   size_t            /*n*/);
+   /*
+    * Adds the 'n' characters at 'offset' beyond the current write position
+    * of a specified ring buffer to its index. This must be done after those
+    * characters have been written. Behaviour is undefined if offset+n is
+    * greater than the buffer size.
+    */
+
+bool RingIndex_match_next(RingIndex        */*index*/,
+                          const RingBuffer */*ring*/,
+                          size_t            /*matched*/,
+                          int               /*c*/);
+   /*
+    * Tries to extend every sequence already matched in a specified ring
+    * buffer by one character, 'c' (converted to an unsigned char). The
+    * 'matched' argument is the number of characters already matched; if it
+    * is 0 then a new search is started. Sequences are not allowed to include
+    * the most recently written character, which means that none can be
+    * longer than the buffer size minus 1. The ring buffer must not be
+    * written to between calls that continue the same search.
+    * Returns: true if at least one sequence was extended, otherwise false
+    *          (in which case the set of matching sequences is unchanged).
+    */
+
+size_t RingIndex_match_offset(const RingIndex  */*index*/,
+                              const RingBuffer */*ring*/,
+                              size_t            /*matched*/);
+   /*
+    * Gets the offset of the first of the sequences matched by the search
+    * in progress (i.e. the oldest). The 'matched' argument is the number of
+    * characters already matched, which must not be 0.
+    * Returns: offset from the write position to the start of the sequence.
+    */
+
+#endif
@@ -36,6 +36,11 @@
                   to cast the matching parameters.
   CJB: 30-May-16: Can now simulate failure of malloc in RingBuffer_make.
   CJB: 21-Jan-18: Made debugging output even less verbose.
+  CJB: 16-Oct-26: RingBuffer_reset no longer clears the buffer. Characters
+                  that haven't been written since are read as zeros by
+                  RingBuffer_copy instead, via new function
+                  RingBuffer_get_chars.
+                  Memory is allocated using a client-supplied allocator.
 */
 
 /* ISO library header files */
@@ -47,20 +52,36 @@
 /* Local headers */
 #include "Internal/RingBuffer.h"
 #include "Internal/GKeyMisc.h"
+#include "Internal/GKeyAlloc.h"
 
-RingBuffer *RingBuffer_make(unsigned int size_log_2)
+enum
 {
-  RingBuffer * const ring = malloc(offsetof(RingBuffer, buffer) +
-                                   (size_t)(1ul << size_log_2));
+  ZeroBlockSize = 256 /* Maximum no. of unwritten characters represented by
+                         one call to RingBuffer_get_chars */
+};
+
+static const unsigned char zeros[ZeroBlockSize];
+
+RingBuffer *RingBuffer_make(unsigned int         size_log_2,
+                            const GKeyAllocator *allocator)
+{
+  RingBuffer * const ring = GKey_alloc(allocator,
+                                       RingBuffer_state_size(size_log_2));
   if (ring != NULL)
     RingBuffer_init(ring, size_log_2);
 
   return ring;
 }
 
-void RingBuffer_destroy(RingBuffer *ring)
+void RingBuffer_destroy(RingBuffer          *ring,
+                        const GKeyAllocator *allocator)
+{
+  GKey_free(allocator, ring);
+}
+
+size_t RingBuffer_state_size(unsigned int size_log_2)
 {
-  free(ring);
+  return offsetof(RingBuffer, buffer) + (size_t)(1ul << size_log_2);
 }
 
 void RingBuffer_init(RingBuffer *ring, unsigned int size_log_2)
@@ -73,9 +94,38 @@ void RingBuffer_init(RingBuffer *ring, unsigned int size_log_2)
 
 void RingBuffer_reset(RingBuffer *ring)
 {
+  assert(ring != NULL);
+
+  /* Everything from the write position to the end of the buffer now reads
+     as zeros until overwritten, so there is no need to clear it. */
   ring->write_pos = 0;
   ring->filled = false;
-  memset(&ring->buffer, 0, ring->size);
+}
+
+const void *RingBuffer_get_chars(const RingBuffer *ring,
+                                 size_t            offset,
+                                 size_t           *n)
+{
+  size_t read_pos, end;
+
+  assert(ring != NULL);
+  assert(n != NULL);
+  assert(offset + *n <= ring->size);
+
+  read_pos = (ring->write_pos + offset) & (ring->size - 1);
+
+  if (!ring->filled && read_pos >= ring->write_pos)
+  {
+    /* Never written since the ring buffer was reset */
+    *n = LOWEST(LOWEST(*n, ring->size - read_pos), ZeroBlockSize);
+    return zeros;
+  }
+
+  /* If the write position hasn't wrapped around yet then only characters
+     before it have been written */
+  end = ring->filled ? ring->size : ring->write_pos;
+  *n = LOWEST(*n, end - read_pos);
+  return ring->buffer + read_pos;
 }
 
 void RingBuffer_write(RingBuffer *ring, const void *s, size_t n)
@@ -139,14 +189,12 @@ size_t RingBuffer_copy(RingBuffer *ring, RingBufferWriteFn *write_cb, void *cb_a
 
   for (total = 0; total < n && copied >= to_copy; total += copied)
   {
-    /* Copy as much of the source data before the end of the ring buffer as
-       will fit in the output buffer. */
-    const size_t read_pos = (ring->write_pos + offset) & (ring->size - 1);
-    const void * const s = ring->buffer + read_pos;
-
-    to_copy = ring->size - read_pos;
-    if (to_copy > n - total)
-      to_copy = n - total;
+    /* Copy as much of the contiguous source data as will fit in the output
+       buffer. */
+    const void *s;
+
+    to_copy = n - total;
+    s = RingBuffer_get_chars(ring, offset, &to_copy);
 
     /* If a callback function was provided then offer it the address range
        first so it can truncate it if necessary. */
@@ -0,0 +1,209 @@
+/*
+ * GKeyLib: Ring buffer hash chains
+ * Copyright (C) 2026 Christopher Bazley
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/* History:
+  CJB: 16-Oct-26: Created this source file.
+*/
+
+/* ISO library header files */
+#include <stddef.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+/* Local headers */
+#include "Internal/RingBuffer.h"
+#include "Internal/RingHash.h"
+#include "Internal/GKeyMisc.h"
+#include "Internal/GKeyAlloc.h"
+
+static uint32_t hash_chars(const unsigned char *chars)
+{
+  /* Multiplicative hash of the first RingHashMinSize characters, keeping
+     the best-mixed upper bits */
+  const uint32_t word = (uint32_t)chars[0] |
+                        ((uint32_t)chars[1] << 8) |
+                        ((uint32_t)chars[2] << 16) |
+                        ((uint32_t)chars[3] << 24);
+
+  return (uint32_t)(word * UINT32_C(2654435761)) >> (32 - RingHashHeadsLog2);
+}
+
+static size_t get_limit(const RingHash *hash)
+{
+  /* Positions written before the last reset aren't in the hash chains */
+  const uint32_t since_reset = hash->pos - hash->base;
+  return since_reset < hash->limit ? since_reset : hash->limit;
+}
+
+static size_t to_offset(const RingHash *hash, uint32_t pos)
+{
+  const uint32_t distance = hash->pos - pos;
+
+  /* Ignore stale positions, including those left in the hash chains by
+     earlier streams. The ring buffer contents must be compared with the
+     string being searched for anyway, so a false match is harmless. */
+  if (distance < RingHashMinSize || distance > get_limit(hash))
+    return SIZE_MAX;
+
+  return hash->size - distance;
+}
+
+static size_t get_chain_size(unsigned int size_log_2)
+{
+  return (size_t)1 << (size_log_2 < RingHashMaxChainLog2 ?
+                       size_log_2 : RingHashMaxChainLog2);
+}
+
+RingHash *RingHash_make(unsigned int         size_log_2,
+                        const GKeyAllocator *allocator)
+{
+  RingHash * const hash = GKey_alloc(allocator,
+                                     RingHash_state_size(size_log_2));
+  if (hash != NULL)
+    RingHash_init(hash, size_log_2);
+
+  return hash;
+}
+
+size_t RingHash_state_size(unsigned int size_log_2)
+{
+  return offsetof(RingHash, heads) +
+         sizeof(uint32_t) * (((size_t)1 << RingHashHeadsLog2) +
+                             get_chain_size(size_log_2));
+}
+
+void RingHash_init(RingHash *hash, unsigned int size_log_2)
+{
+  const size_t size = (size_t)1 << size_log_2,
+               chain_size = get_chain_size(size_log_2);
+
+  assert(hash != NULL);
+  hash->size = size;
+  hash->limit = chain_size < size ? chain_size : size - 1;
+  hash->chain_mask = chain_size - 1;
+  hash->chain = hash->heads + ((size_t)1 << RingHashHeadsLog2);
+
+  /* Positions are only ever validated by their distance back from the
+     current position, so clear the heads once to avoid reading
+     indeterminate values. The chains are never read before being
+     written. */
+  memset(hash->heads, 0,
+         sizeof(uint32_t) * ((size_t)1 << RingHashHeadsLog2));
+  hash->pos = 1; /* so that position 0 precedes the first reset */
+  RingHash_reset(hash);
+}
+
+void RingHash_destroy(RingHash            *hash,
+                      const GKeyAllocator *allocator)
+{
+  GKey_free(allocator, hash);
+}
+
+void RingHash_reset(RingHash *hash)
+{
+  assert(hash != NULL);
+
+  /* Positions written before now become stale */
+  hash->base = hash->pos;
+  hash->hashed = hash->pos;
+}
+
+void RingHash_rebuild(RingHash         *hash,
+                      const RingBuffer *ring,
+                      size_t            n)
+{
+  assert(hash != NULL);
+  assert(ring != NULL);
+  assert(n <= ring->size);
+
+  /* Move the current position far enough forward that every position
+     already in the hash chains is stale */
+  hash->pos += (uint32_t)hash->size;
+  RingHash_reset(hash);
+
+  /* Positions older than the limit would be ignored anyway */
+  RingHash_add(hash, ring, LOWEST(n, hash->limit + RingHashMinSize));
+}
+
+void RingHash_add(RingHash         *hash,
+                  const RingBuffer *ring,
+                  size_t            n)
+{
+  assert(hash != NULL);
+  assert(ring != NULL);
+  assert(ring->size == hash->size);
+  assert(n <= ring->size);
+
+  hash->pos += (uint32_t)n;
+
+  /* Insert every position at which a whole sequence of RingHashMinSize
+     characters has now been written */
+  while (hash->pos - hash->hashed >= RingHashMinSize)
+  {
+    const size_t mask = ring->size - 1;
+    const size_t start = (ring->write_pos -
+                          (size_t)(hash->pos - hash->hashed)) & mask;
+    unsigned char chars[RingHashMinSize];
+
+    for (size_t i = 0; i < RingHashMinSize; ++i)
+      chars[i] = ring->buffer[(start + i) & mask];
+
+    const uint32_t h = hash_chars(chars);
+    hash->chain[hash->hashed & hash->chain_mask] =
+      hash->heads[h];
+    hash->heads[h] = hash->hashed++;
+  }
+}
+
+size_t RingHash_first(const RingHash   *hash,
+                      const RingBuffer *ring,
+                      const void       *s)
+{
+  assert(hash != NULL);
+  assert(ring != NULL);
+  assert(ring->size == hash->size);
+  assert(s != NULL);
+  NOT_USED(ring);
+
+  return to_offset(hash, hash->heads[hash_chars(s)]);
+}
+
+size_t RingHash_next(const RingHash   *hash,
+                     const RingBuffer *ring,
+                     size_t            offset)
+{
+  uint32_t pos;
+  size_t next;
+
+  assert(hash != NULL);
+  assert(ring != NULL);
+  assert(ring->size == hash->size);
+  assert(offset < hash->size);
+  NOT_USED(ring);
+
+  pos = hash->pos - (uint32_t)(hash->size - offset);
+  next = to_offset(hash, hash->chain[pos & hash->chain_mask]);
+
+  /* Chains must lead to older positions; anything else is stale */
+  if (next != SIZE_MAX && next >= offset)
+    next = SIZE_MAX;
+
+  return next;
+}
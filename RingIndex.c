@@ -0,0 +1,285 @@
+/*
+ * GKeyLib: Ring buffer character index
+ * Copyright (C) 2026 Christopher Bazley
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/* History:
+  CJB: 16-Oct-26: Created this source file.
+*/
+
+/* ISO library header files */
+#include <stddef.h>
+#include <string.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <stdbool.h>
+
+/* Local headers */
+#include "Internal/RingBuffer.h"
+#include "Internal/RingIndex.h"
+#include "Internal/GKeyMisc.h"
+#include "Internal/GKeyAlloc.h"
+
+enum
+{
+  ULongMinBit = 32, /* Minimum no. of bits in type 'unsigned long'. */
+  MaxWords = (1u << RingIndexMaxSizeLog2) / ULongMinBit,
+  WordBit = CHAR_BIT * sizeof(unsigned long)
+};
+
+static unsigned long *get_vector(const RingIndex *index, int c)
+{
+  assert(c >= 0);
+  assert(c <= UCHAR_MAX);
+  return (unsigned long *)index->vectors + (size_t)c * index->nwords;
+}
+
+static unsigned int lowest_bit(unsigned long word)
+{
+  unsigned int n = 0;
+
+  assert(word != 0);
+  while ((word & UCHAR_MAX) == 0)
+  {
+    word >>= CHAR_BIT;
+    n += CHAR_BIT;
+  }
+  while ((word & 1) == 0)
+  {
+    word >>= 1;
+    ++n;
+  }
+  return n;
+}
+
+static size_t get_nwords(unsigned int size_log_2)
+{
+  assert(size_log_2 <= RingIndexMaxSizeLog2);
+  return (((size_t)1 << size_log_2) + WordBit - 1) / WordBit;
+}
+
+RingIndex *RingIndex_make(unsigned int         size_log_2,
+                          const GKeyAllocator *allocator)
+{
+  RingIndex * const index = GKey_alloc(allocator,
+                                       RingIndex_state_size(size_log_2));
+  if (index != NULL)
+    RingIndex_init(index, size_log_2);
+
+  return index;
+}
+
+size_t RingIndex_state_size(unsigned int size_log_2)
+{
+  /* A bit vector for every character value plus one to hold the state of
+     a search */
+  return offsetof(RingIndex, vectors) +
+         sizeof(unsigned long) * get_nwords(size_log_2) * (UCHAR_MAX + 2);
+}
+
+void RingIndex_init(RingIndex *index, unsigned int size_log_2)
+{
+  assert(index != NULL);
+  index->size = (size_t)1 << size_log_2;
+  index->nwords = get_nwords(size_log_2);
+  index->ends = index->vectors + index->nwords * (UCHAR_MAX + 1);
+  RingIndex_reset(index);
+}
+
+void RingIndex_destroy(RingIndex           *index,
+                       const GKeyAllocator *allocator)
+{
+  GKey_free(allocator, index);
+}
+
+void RingIndex_reset(RingIndex *index)
+{
+  unsigned long *zeros;
+
+  assert(index != NULL);
+  memset(index->vectors, 0,
+         sizeof(unsigned long) * index->nwords * (UCHAR_MAX + 2));
+
+  /* A ring buffer is initially filled with nul characters */
+  zeros = get_vector(index, '\0');
+  if (index->size < WordBit)
+  {
+    zeros[0] = (1ul << index->size) - 1;
+  }
+  else
+  {
+    for (size_t w = 0; w < index->nwords; ++w)
+      zeros[w] = ~0ul;
+  }
+}
+
+void RingIndex_rebuild(RingIndex        *index,
+                       const RingBuffer *ring)
+{
+  assert(index != NULL);
+  assert(ring != NULL);
+  assert(ring->size == index->size);
+
+  memset(index->vectors, 0,
+         sizeof(unsigned long) * index->nwords * (UCHAR_MAX + 2));
+  RingIndex_add(index, ring, 0, ring->size);
+}
+
+void RingIndex_remove(RingIndex        *index,
+                      const RingBuffer *ring,
+                      size_t            offset,
+                      size_t            n)
+{
+  assert(index != NULL);
+  assert(ring != NULL);
+  assert(ring->size == index->size);
+  assert(offset + n <= ring->size);
+
+  for (size_t i = 0; i < n; ++i)
+  {
+    const size_t pos = (ring->write_pos + offset + i) & (ring->size - 1);
+    unsigned long * const vector = get_vector(index,
+                                   RingBuffer_read_char(ring, offset + i));
+    vector[pos / WordBit] &= ~(1ul << (pos % WordBit));
+  }
+}
+
+void RingIndex_add(RingIndex        *index,
+                   const RingBuffer *ring,
+                   size_t            offset,
+                   size_t            n)
+{
+  assert(index != NULL);
+  assert(ring != NULL);
+  assert(ring->size == index->size);
+  assert(offset + n <= ring->size);
+
+  for (size_t i = 0; i < n; ++i)
+  {
+    const size_t pos = (ring->write_pos + offset + i) & (ring->size - 1);
+    unsigned long * const vector = get_vector(index,
+                                   RingBuffer_read_char(ring, offset + i));
+    vector[pos / WordBit] |= 1ul << (pos % WordBit);
+  }
+}
+
+bool RingIndex_match_next(RingIndex        *index,
+                          const RingBuffer *ring,
+                          size_t            matched,
+                          int               c)
+{
+  unsigned long ends[MaxWords], any = 0;
+  const unsigned long *vector;
+  size_t last, nwords;
+
+  assert(index != NULL);
+  assert(ring != NULL);
+  assert(ring->size == index->size);
+  assert(matched < ring->size);
+
+  nwords = index->nwords;
+  vector = get_vector(index, (unsigned char)c);
+
+  if (matched == 0)
+  {
+    /* Any occurrence of the character can start a new sequence */
+    for (size_t w = 0; w < nwords; ++w)
+      ends[w] = vector[w];
+  }
+  else if (index->size < WordBit)
+  {
+    /* Rotate the end positions of the sequences matched so far by one bit
+       within a partial word, and keep only those that also match the new
+       character. */
+    const unsigned long old_ends = index->ends[0];
+    ends[0] = ((old_ends << 1) | (old_ends >> (index->size - 1))) &
+              vector[0] & ((1ul << index->size) - 1);
+  }
+  else
+  {
+    /* Ditto, except that each word's top bit is carried into the next
+       word's bottom bit and the last word's top bit wraps around. */
+    unsigned long carry = index->ends[nwords - 1] >> (WordBit - 1);
+    for (size_t w = 0; w < nwords; ++w)
+    {
+      const unsigned long old_ends = index->ends[w];
+      ends[w] = ((old_ends << 1) | carry) & vector[w];
+      carry = old_ends >> (WordBit - 1);
+    }
+  }
+
+  /* The most recently written character can't be copied because no
+     sequence can be as long as the ring buffer itself. */
+  last = (ring->write_pos - 1) & (ring->size - 1);
+  ends[last / WordBit] &= ~(1ul << (last % WordBit));
+
+  for (size_t w = 0; w < nwords; ++w)
+    any |= ends[w];
+
+  if (any != 0)
+  {
+    for (size_t w = 0; w < nwords; ++w)
+      index->ends[w] = ends[w];
+  }
+
+  DEBUG_VERBOSEF("RingIndex: %s sequences of length %zu with 0x%02x\n",
+                 any ? "extended" : "can't extend", matched, c);
+
+  return any != 0;
+}
+
+size_t RingIndex_match_offset(const RingIndex  *index,
+                              const RingBuffer *ring,
+                              size_t            matched)
+{
+  size_t first_word, w, pos;
+  unsigned int first_bit;
+  unsigned long word;
+
+  assert(index != NULL);
+  assert(ring != NULL);
+  assert(ring->size == index->size);
+  assert(matched > 0);
+  assert(matched < ring->size);
+
+  /* The oldest sequence is the one that ends at the lowest offset, so
+     search from the write position (which holds the oldest character) in
+     the direction of writing, wrapping around at the end of the buffer. */
+  first_word = ring->write_pos / WordBit;
+  first_bit = ring->write_pos % WordBit;
+
+  word = index->ends[first_word] & (~0ul << first_bit);
+  for (w = first_word; word == 0; word = index->ends[w])
+  {
+    if (++w >= index->nwords)
+      w = 0;
+
+    if (w == first_word)
+    {
+      /* Back where we started, so look at the bits we skipped */
+      word = index->ends[w];
+      break;
+    }
+  }
+  assert(word != 0);
+
+  pos = w * WordBit + lowest_bit(word);
+  DEBUG_VERBOSEF("RingIndex: sequence of length %zu ends at position %zu\n",
+                 matched, pos);
+
+  return ((pos - ring->write_pos) & (ring->size - 1)) + 1 - matched;
+}
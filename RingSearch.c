@@ -24,6 +24,11 @@
   CJB: 18-Apr-15: Assertions are now provided by debug.h.
   CJB: 21-Apr-16: Substituted format specifier %zu for %lu to avoid the need
                   to cast the matching parameters.
+  CJB: 16-Oct-26: Added RingBuffer_mismatch and RingBuffer_match, which
+                  compare a whole word at a time until they find a
+                  difference.
+                  Characters not written since the ring buffer was reset
+                  are now read as zeros, regardless of the buffer content.
 */
 
 /* ISO library header files */
@@ -37,6 +42,64 @@
 #include "Internal/RingBuffer.h"
 #include "Internal/GKeyMisc.h"
 
+enum
+{
+  PrefixBlockSize = 64 /* No. of characters compared by each call to memcmp
+                          when searching for a mismatch */
+};
+
+static size_t common_prefix(const unsigned char *s1,
+                            const unsigned char *s2,
+                            size_t               n)
+{
+  size_t i, block_end;
+
+  /* Skip equal blocks using memcmp, which is typically provided by the C
+     library in a form optimised for the host CPU, then find the mismatch
+     (if any) within the first unequal block. */
+  for (i = 0; n - i > PrefixBlockSize; i += PrefixBlockSize)
+  {
+    if (memcmp(s1 + i, s2 + i, PrefixBlockSize) != 0)
+      break;
+  }
+  block_end = LOWEST(n, i + PrefixBlockSize);
+
+  /* Compare a word at a time until a mismatch is found. Loading words via
+     memcpy avoids any alignment restrictions and endianness doesn't matter
+     because only equality is tested. */
+  for (; block_end - i >= sizeof(unsigned long); i += sizeof(unsigned long))
+  {
+    unsigned long word1, word2;
+    memcpy(&word1, s1 + i, sizeof(word1));
+    memcpy(&word2, s2 + i, sizeof(word2));
+    if (word1 != word2)
+      break;
+  }
+
+  /* Locate the first mismatching character within the last word compared,
+     or compare any characters left over at the end */
+  while (i < block_end && s1[i] == s2[i])
+    ++i;
+
+  return i;
+}
+
+static const unsigned char *get_chars(const RingBuffer *ring,
+                                     size_t            offset,
+                                     size_t           *n)
+{
+  /* Once the write position has wrapped around, every character has been
+     written, so there is no need to check for unwritten characters. */
+  if (ring->filled)
+  {
+    const size_t read_pos = (ring->write_pos + offset) & (ring->size - 1);
+    *n = LOWEST(*n, ring->size - read_pos);
+    return ring->buffer + read_pos;
+  }
+
+  return RingBuffer_get_chars(ring, offset, n);
+}
+
 int RingBuffer_read_char(const RingBuffer *ring, size_t offset)
 {
   int c;
@@ -45,7 +108,10 @@ int RingBuffer_read_char(const RingBuffer *ring, size_t offset)
   assert(offset < ring->size);
 
   offset = (ring->write_pos + offset) & (ring->size - 1);
-  c = ring->buffer[offset];
+  if (!ring->filled && offset >= ring->write_pos)
+    c = '\0'; /* not written since the ring buffer was reset */
+  else
+    c = ring->buffer[offset];
 
   DEBUG_VERBOSEF("RingBuffer: read 0x%02x from position %zu\n",
                 c, offset);
@@ -104,7 +170,6 @@ size_t RingBuffer_find_char(const RingBuffer *ring,
   {
     DEBUG_VERBOSEF("RingBuffer: %p..%p is known to be zero\n",
                   start, start + to_search - 1);
-    assert(*start == '\0');
     if (c == '\0')
       match = start; /* match at start position */
     else
@@ -136,7 +201,7 @@ size_t RingBuffer_find_char(const RingBuffer *ring,
   {
     found = match - start + offset;
     assert(found < ring->size);
-    assert(ring->buffer[(ring->write_pos + found) & (ring->size - 1)] == c);
+    assert(RingBuffer_read_char(ring, found) == c);
 
     DEBUG_VERBOSEF("RingBuffer: found match at %p (offset %zu, pos %zu)\n",
                   match, found,
@@ -155,7 +220,7 @@ int RingBuffer_compare(const RingBuffer *ring,
                        size_t            offset2,
                        size_t            n)
 {
-  size_t len1, len2, abs_read1, abs_read2, to_compare, nleft;
+  size_t len1, len2, to_compare, nleft;
   const unsigned char *start1, *start2;
   int diff = 0;
 
@@ -170,51 +235,24 @@ int RingBuffer_compare(const RingBuffer *ring,
                 offset2,
                 ring->write_pos + offset2);
 
-  /* Calculate absolute read positions within the buffer */
-  abs_read1 = (ring->write_pos + offset1) & (ring->size - 1);
-  abs_read2 = (ring->write_pos + offset2) & (ring->size - 1);
-
-  start1 = ring->buffer + abs_read1;
-  start2 = ring->buffer + abs_read2;
-
   if (n == 1)
   {
     /* Single character compare */
-    diff = *start1 - *start2;
+    len1 = len2 = 1;
+    diff = *get_chars(ring, offset1, &len1) - *get_chars(ring, offset2, &len2);
   }
   else
   {
-    /* Multiple character compare */
-    if (ring->write_pos > abs_read1)
-    {
-      /* Check characters between start position and write position */
-      len1 = ring->write_pos - abs_read1;
-    }
-    else
-    {
-      /* Otherwise until reaching the end of buffer */
-      assert(ring->size > abs_read1);
-      len1 = ring->size - abs_read1;
-    }
-    if (ring->write_pos > abs_read2)
-    {
-      /* Check characters between start position and write position */
-      len2 = ring->write_pos - abs_read2;
-    }
-    else
-    {
-      /* Otherwise until reaching the end of buffer */
-      assert(ring->size > abs_read2);
-      len2 = ring->size - abs_read2;
-    }
-
     /* Split the comparison into contiguous address ranges. This may require
        several iterations, because we need to restart upon reaching the end of
-       the buffer (for either sequence) or the limit specified by the caller */
+       the buffer or the write position (for either sequence) or the limit
+       specified by the caller */
     for (nleft = n; nleft != 0; nleft -= to_compare)
     {
-      /* Ensure we don't exceed the read limit imposed by the caller */
-      to_compare = LOWEST(LOWEST(len1, len2), nleft);
+      len1 = len2 = nleft;
+      start1 = get_chars(ring, offset1, &len1);
+      start2 = get_chars(ring, offset2, &len2);
+      to_compare = LOWEST(len1, len2);
 
       /* Compare the two contiguous address ranges */
       DEBUG_VERBOSEF("RingBuffer: comparing %p..%p with %p..%p\n",
@@ -225,38 +263,83 @@ int RingBuffer_compare(const RingBuffer *ring,
       if (diff != 0)
         break; /* found a mismatch */
 
-      /* Find next contiguous address range of sequence 1 */
-      assert(len1 >= to_compare);
-      len1 -= to_compare;
-      if (len1 == 0)
-      {
-        /* Check characters between start of buffer and write position */
-        start1 = ring->buffer;
-        len1 = ring->write_pos;
-      }
-      else
-      {
-        /* Haven't reached end of current contiguous address range */
-        start1 += to_compare;
-      }
-
-      /* Find next contiguous address range of sequence 2 */
-      assert(len2 >= to_compare);
-      len2 -= to_compare;
-      if (len2 == 0)
-      {
-        /* Check characters between start of buffer and write position */
-        start2 = ring->buffer;
-        len2 = ring->write_pos;
-      }
-      else
-      {
-        /* Haven't reached end of current contiguous address range */
-        start2 += to_compare;
-      }
+      offset1 += to_compare;
+      offset2 += to_compare;
     }
   }
   DEBUG_VERBOSEF("RingBuffer: Result of comparison is %s\n",
                 diff < 0 ? "less" : diff == 0 ? "equal" : "greater");
   return diff;
 }
+
+size_t RingBuffer_mismatch(const RingBuffer *ring,
+                           size_t            offset1,
+                           size_t            offset2,
+                           size_t            n)
+{
+  size_t len1, len2, total, to_compare, same;
+
+  assert(ring != NULL);
+  assert(offset1+n <= ring->size);
+  assert(offset2+n <= ring->size);
+
+  DEBUG_VERBOSEF("RingBuffer: Finding mismatch in %zu bytes at offset %zu "
+                 "and offset %zu in ring buffer\n", n, offset1, offset2);
+
+  /* Split the comparison into contiguous address ranges, restarting upon
+     reaching the end of the buffer or the write position (for either
+     sequence) */
+  for (total = 0; total < n; total += same)
+  {
+    const unsigned char *start1, *start2;
+
+    len1 = len2 = n - total;
+    start1 = get_chars(ring, offset1 + total, &len1);
+    start2 = get_chars(ring, offset2 + total, &len2);
+    to_compare = LOWEST(len1, len2);
+
+    same = common_prefix(start1, start2, to_compare);
+    if (same < to_compare)
+    {
+      total += same;
+      break; /* found a mismatch */
+    }
+  }
+
+  DEBUG_VERBOSEF("RingBuffer: %zu bytes are equal\n", total);
+  return total;
+}
+
+size_t RingBuffer_match(const RingBuffer *ring,
+                        size_t            offset,
+                        const void       *s,
+                        size_t            n)
+{
+  size_t total, to_compare, same;
+
+  assert(ring != NULL);
+  assert(s != NULL || n == 0);
+  assert(offset+n <= ring->size);
+
+  DEBUG_VERBOSEF("RingBuffer: Matching %zu bytes at offset %zu in ring buffer "
+                 "with %p\n", n, offset, s);
+
+  /* Split the comparison into contiguous address ranges, restarting upon
+     reaching the end of the buffer or the write position */
+  for (total = 0; total < n; total += same)
+  {
+    to_compare = n - total;
+    const unsigned char * const start = get_chars(ring, offset + total,
+                                                  &to_compare);
+
+    same = common_prefix(start, (const unsigned char *)s + total, to_compare);
+    if (same < to_compare)
+    {
+      total += same;
+      break; /* found a mismatch */
+    }
+  }
+
+  DEBUG_VERBOSEF("RingBuffer: %zu bytes are equal\n", total);
+  return total;
+}
@@ -0,0 +1,157 @@
+/*
+ * GKeyLib benchmark: Common functions
+ * Copyright (C) 2026 Christopher Bazley
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/* ISO library headers */
+#include <limits.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/* GKeyLib headers */
+#include "GKeyComp.h"
+#include "GKeyDecomp.h"
+
+/* Local headers */
+#include "Bench.h"
+
+static double check(unsigned int history_log_2, const void *in,
+                    size_t in_size, const void *out, size_t out_size)
+{
+  unsigned char * const check_buf = malloc(in_size);
+  Bench_check_alloc(check_buf);
+
+  const clock_t start = clock();
+
+  GKeyDecomp * const decomp = gkeydecomp_make(history_log_2);
+  Bench_check_alloc(decomp);
+
+  GKeyParameters params = {
+    .in_buffer = out,
+    .in_size = out_size,
+    .out_buffer = check_buf,
+    .out_size = in_size,
+  };
+
+  const GKeyStatus status = gkeydecomp_decompress(decomp, &params);
+  gkeydecomp_destroy(decomp);
+
+  const double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+  if (status != GKeyStatus_OK || params.out_size != 0 ||
+      memcmp(in, check_buf, in_size) != 0)
+  {
+    fprintf(stderr, "Decompressed data doesn't match\n");
+    exit(EXIT_FAILURE);
+  }
+
+  free(check_buf);
+  return seconds;
+}
+
+void Bench_check_alloc(void *ptr)
+{
+  if (ptr == NULL)
+  {
+    fprintf(stderr, "Not enough memory\n");
+    exit(EXIT_FAILURE);
+  }
+}
+
+BenchResult Bench_compress(unsigned int  history_log_2,
+                           GKeyCompMode  mode,
+                           const void   *in,
+                           size_t        in_size)
+{
+  /* Literals need 9 bits per byte, plus one byte for the final flush */
+  const size_t max_out_size = in_size + in_size / CHAR_BIT + 1;
+  unsigned char * const out = malloc(max_out_size);
+  BenchResult result;
+  Bench_check_alloc(out);
+
+  const clock_t start = clock();
+
+  GKeyComp * const comp = gkeycomp_make(history_log_2);
+  Bench_check_alloc(comp);
+  gkeycomp_set_mode(comp, mode);
+  if (mode == GKeyCompMode_Deadline)
+  {
+    gkeycomp_set_deadline(comp, in_size,
+                          (clock_t)((double)in_size * BenchDeadlineNsPerByte *
+                                    CLOCKS_PER_SEC / 1e9));
+  }
+
+  GKeyParameters params = {
+    .in_buffer = in,
+    .in_size = in_size,
+    .out_buffer = out,
+    .out_size = max_out_size,
+  };
+
+  /* The first call consumes all of the input, and the second flushes */
+  GKeyStatus status = gkeycomp_compress(comp, &params);
+  if (status == GKeyStatus_OK)
+    status = gkeycomp_compress(comp, &params);
+
+  gkeycomp_destroy(comp);
+
+  result.seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+  if (status != GKeyStatus_Finished)
+  {
+    fprintf(stderr, "Compression failed: %s\n", GKey_get_status_str(status));
+    exit(EXIT_FAILURE);
+  }
+
+  result.out_size = max_out_size - params.out_size;
+  result.decomp_seconds = check(history_log_2, in, in_size, out,
+                                result.out_size);
+  free(out);
+
+  return result;
+}
+
+void Bench_print(const char   *input_name,
+                 unsigned int  history_log_2,
+                 GKeyCompMode  mode,
+                 size_t        in_size,
+                 BenchResult   result)
+{
+  static const char *const mode_names[] = { "Best", "Adaptive", "Bounded",
+                                            "Deadline" };
+
+  assert((size_t)mode < ARRAY_SIZE(mode_names));
+  printf("%-16s %2u %-8s %8zu -> %8zu (%5.1f%%) %8.3f s %8.1f ns/byte\n",
+         input_name, history_log_2, mode_names[mode], in_size,
+         result.out_size, in_size ? 100.0 * result.out_size / in_size : 0.0,
+         result.seconds, in_size ? result.seconds * 1e9 / in_size : 0.0);
+}
+
+static unsigned long random_seed = 1;
+
+unsigned char Bench_random(void)
+{
+  random_seed = (random_seed * 1103515245ul + 12345ul) & 0xffffffff;
+  return (unsigned char)(random_seed >> 16);
+}
+
+void Bench_seed(unsigned long seed)
+{
+  random_seed = seed & 0xffffffff;
+}
@@ -0,0 +1,93 @@
+/*
+ * GKeyLib benchmark: Macro and benchmark suite definitions
+ * Copyright (C) 2026 Christopher Bazley
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef Bench_h
+#define Bench_h
+
+#include <stddef.h>
+#include <assert.h>
+
+/* GKeyLib headers */
+#include "GKeyComp.h"
+
+#define NOT_USED(x) ((void)(x))
+#define ARRAY_SIZE(array) (sizeof(array) / sizeof((array)[0]))
+#define LOWEST(a, b) ((a) < (b) ? (a) : (b))
+
+enum
+{
+  BenchDeadlineNsPerByte = 100 /* Processor time allowed per byte of input
+                                  in mode GKeyCompMode_Deadline */
+};
+
+typedef struct
+{
+  size_t out_size;       /* No. of bytes of compressed data */
+  double seconds;        /* Processor time taken to compress the data */
+  double decomp_seconds; /* Processor time taken to decompress the data */
+}
+BenchResult;
+
+BenchResult Bench_compress(unsigned int  /*history_log_2*/,
+                           GKeyCompMode  /*mode*/,
+                           const void   */*in*/,
+                           size_t        /*in_size*/);
+   /*
+    * Compresses a buffer of data in one call (plus one to flush), timing
+    * the whole operation including creation of the compressor. In mode
+    * GKeyCompMode_Deadline, the schedule allows BenchDeadlineNsPerByte
+    * for each byte of input. The output is decompressed afterwards (also
+    * timed) to check that it matches the input.
+    * Returns: the size of the compressed data and the times taken.
+    */
+
+void Bench_print(const char   */*input_name*/,
+                 unsigned int  /*history_log_2*/,
+                 GKeyCompMode  /*mode*/,
+                 size_t        /*in_size*/,
+                 BenchResult   /*result*/);
+   /*
+    * Prints one line of a table of benchmark results.
+    */
+
+void Bench_check_alloc(void */*ptr*/);
+   /*
+    * Exits with an error message if 'ptr' is a null pointer, which is how
+    * failure to allocate memory or create an object is indicated.
+    */
+
+unsigned char Bench_random(void);
+   /*
+    * Gets the next byte from a fixed sequence of pseudo-random values.
+    */
+
+void Bench_seed(unsigned long /*seed*/);
+   /*
+    * Restarts the sequence of values returned by Bench_random from a
+    * given seed, so that data can be generated reproducibly whichever
+    * benchmarks were run before.
+    */
+
+extern void Chunk_bench(void);
+extern void Corpus_bench(void);
+extern void Pathological_bench(void);
+extern void Ring_bench(void);
+extern void Window_bench(void);
+
+#endif /* Bench_h */
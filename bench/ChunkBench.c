@@ -0,0 +1,152 @@
+/*
+ * GKeyLib benchmark: Compression of input in small chunks
+ * Copyright (C) 2026 Christopher Bazley
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+/* ISO library headers */
+#include <limits.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/* GKeyLib headers */
+#include "GKeyComp.h"
+
+/* Local headers */
+#include "Bench.h"
+
+enum
+{
+  InputSize = 1 << 20,
+  HistoryLog2 = 9,
+  StageSize = 1 << 14,
+  MaxChunkSizeLog2 = 20
+};
+
+static void make_text(unsigned char *buf, size_t size)
+{
+  static const char *const words[] =
+  {
+    "sprite", "tile", "map", "track", "level", "score", "bonus", "enemy",
+    "player", "weapon", "shield", "the", "of", "and", "a", "to"
+  };
+
+  for (size_t pos = 0; pos < size; )
+  {
+    const char *const word = words[Bench_random() % ARRAY_SIZE(words)];
+    for (size_t i = 0; word[i] != '\0' && pos < size; ++i)
+      buf[pos++] = word[i];
+    if (pos < size)
+      buf[pos++] = Bench_random() % 8 ? ' ' : '\n';
+  }
+}
+
+static BenchResult compress_chunks(const unsigned char *in, size_t in_size,
+                                   size_t chunk_size, size_t stage_size,
+                                   unsigned char *out, size_t out_size)
+{
+  BenchResult result;
+  GKeyStatus status = GKeyStatus_OK;
+
+  const clock_t start = clock();
+
+  GKeyComp * const comp = gkeycomp_make(HistoryLog2);
+  Bench_check_alloc(comp);
+  if (!gkeycomp_set_staging(comp, stage_size))
+  {
+    fprintf(stderr, "Failed to enable staging\n");
+    exit(EXIT_FAILURE);
+  }
+
+  GKeyParameters params = {
+    .out_buffer = out,
+    .out_size = out_size,
+  };
+
+  for (size_t pos = 0; pos < in_size && status == GKeyStatus_OK;
+       pos += chunk_size)
+  {
+    params.in_buffer = in + pos;
+    params.in_size = LOWEST(chunk_size, in_size - pos);
+    status = gkeycomp_compress(comp, &params);
+  }
+
+  if (status == GKeyStatus_OK)
+    status = gkeycomp_compress(comp, &params);
+
+  gkeycomp_destroy(comp);
+
+  result.seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+  if (status != GKeyStatus_Finished)
+  {
+    fprintf(stderr, "Compression failed: %s\n", GKey_get_status_str(status));
+    exit(EXIT_FAILURE);
+  }
+
+  result.out_size = out_size - params.out_size;
+  return result;
+}
+
+void Chunk_bench(void)
+{
+  /* Literals need 9 bits per byte, plus one byte for the final flush */
+  const size_t max_out_size = InputSize + InputSize / CHAR_BIT + 1;
+  unsigned char * const in = malloc(InputSize);
+  unsigned char * const out = malloc(max_out_size);
+  unsigned char * const check = malloc(max_out_size);
+  Bench_check_alloc(in);
+  Bench_check_alloc(out);
+  Bench_check_alloc(check);
+
+  make_text(in, InputSize);
+
+  const BenchResult ref = compress_chunks(in, InputSize, InputSize, 0,
+                                          check, max_out_size);
+
+  printf("%-8s %14s %14s\n", "chunk", "direct ns/byte", "staged ns/byte");
+  for (unsigned int c = 0; c <= MaxChunkSizeLog2; c += 2)
+  {
+    const size_t chunk_size = (size_t)1 << c;
+    BenchResult result[2];
+
+    for (size_t s = 0; s < ARRAY_SIZE(result); ++s)
+    {
+      result[s] = compress_chunks(in, InputSize, chunk_size,
+                                  s ? StageSize : 0, out, max_out_size);
+
+      /* Compressing in chunks mustn't change the output */
+      if (result[s].out_size != ref.out_size ||
+          memcmp(out, check, ref.out_size) != 0)
+      {
+        fprintf(stderr, "Output for chunk size %zu doesn't match\n",
+                chunk_size);
+        exit(EXIT_FAILURE);
+      }
+    }
+
+    printf("%-8zu %14.1f %14.1f\n", chunk_size,
+           result[0].seconds * 1e9 / InputSize,
+           result[1].seconds * 1e9 / InputSize);
+  }
+
+  free(check);
+  free(out);
+  free(in);
+}
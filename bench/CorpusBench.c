@@ -0,0 +1,370 @@
+/*
+ * GKeyLib benchmark: Synthetic corpus of game data
+ * Copyright (C) 2026 Christopher Bazley
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/* ISO library headers */
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/* GKeyLib headers */
+#include "GKeyComp.h"
+
+/* Local headers */
+#include "Bench.h"
+
+enum
+{
+  InputSize = 1 << 18,
+  Seed = 1,
+  SpriteHeaderSize = 44,
+  SpriteNameSize = 12,
+  MaxSpriteSize = 48,
+  TileMapWidth = 64,
+  TileMapHeight = 64,
+  TileRegionSize = 8,
+  TrackGridSize = 32,
+  TrackPieceSize = 8,
+  TableSize = 4096,
+  TableRecordSize = 32,
+  TableNameSize = 16
+};
+
+static const char JsonFileName[] = "corpus.json";
+
+static const char *const names[] =
+{
+  "ship", "tank", "plane", "tree", "house", "hill", "road", "bridge",
+  "fuel", "ammo", "boat", "crane", "tower", "radar", "wall", "gate"
+};
+
+static void put_word(unsigned char *buf, unsigned long value)
+{
+  /* Little-endian, like the RISC OS file formats the corpus imitates */
+  for (size_t i = 0; i < 4; ++i)
+    buf[i] = (unsigned char)(value >> (8 * i));
+}
+
+static void put_name(unsigned char *buf, size_t size)
+{
+  /* A name padded with zeros */
+  const char *const name = names[Bench_random() % ARRAY_SIZE(names)];
+  memset(buf, 0, size);
+  snprintf((char *)buf, size, "%s%d", name, Bench_random() % 10);
+}
+
+static void make_sprites(unsigned char *buf, size_t size)
+{
+  /* Sprite areas: a header for each sprite followed by 8 bits per pixel
+     image data (a shaded ellipse on a transparent background) and a
+     mask */
+  size_t pos = 0;
+  while (pos < size)
+  {
+    const size_t width = 16 + (Bench_random() % 9) * 4,
+                 height = 16 + Bench_random() % (MaxSpriteSize - 15);
+    const size_t sprite_size = SpriteHeaderSize + width * height * 2;
+    const unsigned char colour = Bench_random() & 0xf0;
+    unsigned char header[SpriteHeaderSize];
+
+    put_word(header, sprite_size);
+    put_name(header + 4, SpriteNameSize);
+    put_word(header + 16, width / 4 - 1);
+    put_word(header + 20, height - 1);
+    put_word(header + 24, 0);
+    put_word(header + 28, 31);
+    put_word(header + 32, SpriteHeaderSize);
+    put_word(header + 36, SpriteHeaderSize + width * height);
+    put_word(header + 40, 28);
+
+    for (size_t i = 0; i < SpriteHeaderSize && pos < size; ++i)
+      buf[pos++] = header[i];
+
+    for (size_t mask = 0; mask < 2; ++mask)
+    {
+      for (size_t y = 0; y < height; ++y)
+      {
+        for (size_t x = 0; x < width && pos < size; ++x)
+        {
+          /* Scale coordinates relative to the centre so that the ellipse
+             fills the sprite */
+          const long dx = (long)(2 * x + 1) - (long)width,
+                     dy = (long)(2 * y + 1) - (long)height;
+          const double d = (double)(dx * dx) / (double)(width * width) +
+                           (double)(dy * dy) / (double)(height * height);
+          unsigned char pixel = 0;
+
+          if (d < 1.0)
+          {
+            if (mask)
+              pixel = 0xff;
+            else if (d > 0.8)
+              pixel = colour | 1; /* outline */
+            else
+              pixel = colour | (unsigned char)(2 + y * 12 / height);
+          }
+          buf[pos++] = pixel;
+        }
+      }
+    }
+  }
+}
+
+static void make_tile_maps(unsigned char *buf, size_t size)
+{
+  /* Maps of 16-bit tile numbers, in which regions of similar terrain are
+     broken up by variant tiles and crossed by roads */
+  size_t pos = 0;
+  while (pos < size)
+  {
+    enum { RegionsPerRow = TileMapWidth / TileRegionSize,
+           RegionsPerColumn = TileMapHeight / TileRegionSize };
+    unsigned char regions[RegionsPerColumn][RegionsPerRow];
+    const size_t road_x = Bench_random() % TileMapWidth,
+                 road_y = Bench_random() % TileMapHeight;
+
+    for (size_t ry = 0; ry < RegionsPerColumn; ++ry)
+      for (size_t rx = 0; rx < RegionsPerRow; ++rx)
+        regions[ry][rx] = Bench_random() % 6;
+
+    for (size_t y = 0; y < TileMapHeight; ++y)
+    {
+      for (size_t x = 0; x < TileMapWidth && pos < size; ++x)
+      {
+        unsigned int tile;
+
+        if (x == road_x || y == road_y)
+          tile = x == road_x && y == road_y ? 0x102 : 0x100 + (x == road_x);
+        else
+          tile = regions[y / TileRegionSize][x / TileRegionSize] * 8 +
+                 (Bench_random() % 8 == 0 ? Bench_random() % 4 : 0);
+
+        buf[pos++] = (unsigned char)tile;
+        if (pos < size)
+          buf[pos++] = (unsigned char)(tile >> 8);
+      }
+    }
+  }
+}
+
+static void make_tracks(unsigned char *buf, size_t size)
+{
+  /* Track files: a list of pieces, each with a type, rotation, position on
+     a grid and height, in which each piece usually continues from the
+     previous one and straight pieces are the most common */
+  unsigned int x = TrackGridSize / 2, y = TrackGridSize / 2, height = 0;
+  unsigned int direction = 0;
+
+  for (size_t pos = 0; pos < size; )
+  {
+    static const signed char dx[] = { 1, 0, -1, 0 }, dy[] = { 0, 1, 0, -1 };
+    unsigned char piece[TrackPieceSize];
+    unsigned int type = 0;
+    const unsigned char r = Bench_random() % 16;
+
+    if (r < 2)
+    {
+      type = 1 + r; /* bend */
+      direction = (direction + (r ? 1 : 3)) % 4;
+    }
+    else if (r < 4)
+    {
+      type = 3 + (r & 1); /* ramp */
+      height = r & 1 ? height + 1 : height > 0 ? height - 1 : 0;
+    }
+    else if (r == 4)
+    {
+      type = 5 + Bench_random() % 4; /* loop, jump or checkpoint */
+    }
+
+    x = (x + dx[direction]) % TrackGridSize;
+    y = (y + dy[direction]) % TrackGridSize;
+
+    piece[0] = (unsigned char)type;
+    piece[1] = (unsigned char)direction;
+    piece[2] = (unsigned char)x;
+    piece[3] = (unsigned char)y;
+    piece[4] = (unsigned char)(height * 64);
+    piece[5] = (unsigned char)(height * 64 >> 8);
+    piece[6] = type == 8 ? 1 : 0; /* flags */
+    piece[7] = 0;
+
+    for (size_t i = 0; i < TrackPieceSize && pos < size; ++i)
+      buf[pos++] = piece[i];
+  }
+}
+
+static void make_tables(unsigned char *buf, size_t size)
+{
+  /* Fixed-size blocks, each containing a variable number of records
+     (a name and some small numbers) padded with zeros */
+  memset(buf, 0, size);
+
+  for (size_t block = 0; block < size; block += TableSize)
+  {
+    const size_t nrecords = 20 + Bench_random() % 81;
+    const size_t end = LOWEST(size, block + TableSize);
+
+    for (size_t r = 0; r < nrecords; ++r)
+    {
+      const size_t pos = block + r * TableRecordSize;
+      unsigned char record[TableRecordSize];
+
+      memset(record, 0, sizeof(record));
+      put_name(record, TableNameSize);
+      put_word(record + 16, r);
+      put_word(record + 20, (Bench_random() << 8 | Bench_random()) % 10000);
+      put_word(record + 24, Bench_random() % 16);
+
+      memcpy(buf + pos, record, LOWEST(TableRecordSize, end - pos));
+    }
+  }
+}
+
+static void make_noise(unsigned char *buf, size_t size)
+{
+  /* Data that has already been compressed or encrypted */
+  for (size_t i = 0; i < size; ++i)
+    buf[i] = Bench_random();
+}
+
+static double get_rate(size_t size, double seconds)
+{
+  return seconds > 0 ? (double)size / seconds / 1e6 : 0.0;
+}
+
+static const char *get_mode_name(GKeyCompMode mode)
+{
+  static const char *const mode_names[] = { "Best", "Adaptive", "Bounded",
+                                            "Deadline" };
+
+  assert((size_t)mode < ARRAY_SIZE(mode_names));
+  return mode_names[mode];
+}
+
+static double get_ratio(size_t in_size, BenchResult result)
+{
+  return result.out_size ? (double)in_size / result.out_size : 0.0;
+}
+
+static void print_json(FILE *f, bool *first, const char *input_name,
+                       unsigned int history_log_2, GKeyCompMode mode,
+                       size_t in_size, BenchResult result)
+{
+  fprintf(f, "%s\n    { \"input\": \"%s\", \"history_log_2\": %u, "
+          "\"mode\": \"%s\", \"in_size\": %zu, \"out_size\": %zu, "
+          "\"ratio\": %.4f, \"compress_mb_s\": %.2f, "
+          "\"decompress_mb_s\": %.2f }",
+          *first ? "" : ",", input_name, history_log_2, get_mode_name(mode),
+          in_size, result.out_size, get_ratio(in_size, result),
+          get_rate(in_size, result.seconds),
+          get_rate(in_size, result.decomp_seconds));
+  *first = false;
+}
+
+void Corpus_bench(void)
+{
+  static const struct
+  {
+    const char *input_name;
+    void (*make_func)(unsigned char *, size_t);
+  }
+  inputs[] =
+  {
+    { "Sprites", make_sprites },
+    { "Tile maps", make_tile_maps },
+    { "Tracks", make_tracks },
+    { "Tables", make_tables },
+    { "Noise", make_noise },
+  };
+  static const unsigned int history_log_2s[] = { 9, 12, 16, 20, 24 };
+  static const GKeyCompMode modes[] = { GKeyCompMode_Best,
+                                        GKeyCompMode_Adaptive,
+                                        GKeyCompMode_Bounded,
+                                        GKeyCompMode_Deadline };
+  unsigned char *in[ARRAY_SIZE(inputs)];
+  bool first = true;
+
+  /* The corpus is the same whichever other benchmarks were run */
+  Bench_seed(Seed);
+  for (size_t i = 0; i < ARRAY_SIZE(inputs); ++i)
+  {
+    in[i] = malloc(InputSize);
+    Bench_check_alloc(in[i]);
+    inputs[i].make_func(in[i], InputSize);
+  }
+
+  FILE *const f = fopen(JsonFileName, "w");
+  if (f == NULL)
+  {
+    fprintf(stderr, "Failed to open %s\n", JsonFileName);
+    exit(EXIT_FAILURE);
+  }
+
+  fprintf(f, "{\n  \"benchmark\": \"Corpus\",\n  \"time\": %ld,\n"
+          "  \"deadline_ns_per_byte\": %d,\n  \"results\": [",
+          (long)time(NULL), BenchDeadlineNsPerByte);
+
+  printf("%2s %-8s %8s %8s %6s %11s %11s\n", "h", "mode", "in", "out",
+         "ratio", "comp MB/s", "decomp MB/s");
+
+  for (size_t h = 0; h < ARRAY_SIZE(history_log_2s); ++h)
+  {
+    for (size_t m = 0; m < ARRAY_SIZE(modes); ++m)
+    {
+      /* The whole corpus is reported as well as each kind of data in it */
+      BenchResult total = { 0, 0.0, 0.0 };
+
+      for (size_t i = 0; i < ARRAY_SIZE(inputs); ++i)
+      {
+        const BenchResult result = Bench_compress(history_log_2s[h],
+                                                  modes[m], in[i], InputSize);
+
+        print_json(f, &first, inputs[i].input_name, history_log_2s[h],
+                   modes[m], InputSize, result);
+
+        total.out_size += result.out_size;
+        total.seconds += result.seconds;
+        total.decomp_seconds += result.decomp_seconds;
+      }
+
+      const size_t total_in = InputSize * ARRAY_SIZE(inputs);
+      print_json(f, &first, "All", history_log_2s[h], modes[m], total_in,
+                 total);
+
+      printf("%2u %-8s %8zu %8zu %6.2f %11.2f %11.2f\n", history_log_2s[h],
+             get_mode_name(modes[m]), total_in, total.out_size,
+             get_ratio(total_in, total), get_rate(total_in, total.seconds),
+             get_rate(total_in, total.decomp_seconds));
+    }
+  }
+
+  fprintf(f, "\n  ]\n}\n");
+  if (fclose(f) != 0)
+  {
+    fprintf(stderr, "Failed to write %s\n", JsonFileName);
+    exit(EXIT_FAILURE);
+  }
+
+  printf("Results written to %s\n", JsonFileName);
+
+  for (size_t i = 0; i < ARRAY_SIZE(inputs); ++i)
+    free(in[i]);
+}
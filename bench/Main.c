@@ -0,0 +1,72 @@
+/*
+ * GKeyLib benchmark: main program
+ * Copyright (C) 2026 Christopher Bazley
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/* ISO library headers */
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Local headers */
+#include "Bench.h"
+
+int main(int argc, char *argv[])
+{
+  static const struct
+  {
+    const char *bench_name;
+    void (*bench_func)(void);
+  }
+  bench_groups[] =
+  {
+    { "Chunk", Chunk_bench },
+    { "Corpus", Corpus_bench },
+    { "Pathological", Pathological_bench },
+    { "Ring", Ring_bench },
+    { "Window", Window_bench },
+  };
+
+  for (size_t count = 0; count < ARRAY_SIZE(bench_groups); count ++)
+  {
+    /* Run only the named groups of benchmarks, if any were specified */
+    if (argc > 1)
+    {
+      int i;
+      for (i = 1; i < argc; ++i)
+      {
+        if (strcmp(argv[i], bench_groups[count].bench_name) == 0)
+          break;
+      }
+      if (i == argc)
+        continue;
+    }
+
+    /* Print title of this group of benchmarks, then underline it */
+    const size_t len = strlen(bench_groups[count].bench_name);
+    puts(bench_groups[count].bench_name);
+    for (size_t i = 0; i < len; i++)
+        putchar('-');
+    putchar('\n');
+
+    bench_groups[count].bench_func();
+
+    putchar('\n');
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,104 @@
+/*
+ * GKeyLib benchmark: Pathological inputs for compression
+ * Copyright (C) 2026 Christopher Bazley
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/* ISO library headers */
+#include <stdlib.h>
+#include <stdio.h>
+
+/* GKeyLib headers */
+#include "GKeyComp.h"
+
+/* Local headers */
+#include "Bench.h"
+
+enum
+{
+  InputSize = 1 << 17
+};
+
+static void make_perturbed_run(unsigned char *buf, size_t size)
+{
+  /* A long run of one value with a different value at irregular intervals,
+     so that almost every position in the history is a candidate but few
+     candidates match for long */
+  for (size_t i = 0; i < size; ++i)
+    buf[i] = Bench_random() % 61 == 0 ? 'b' : 'a';
+}
+
+static void make_small_alphabet(unsigned char *buf, size_t size)
+{
+  /* Random values from a tiny alphabet, interrupted by runs of zeros */
+  for (size_t i = 0; i < size; ++i)
+    buf[i] = (i / 300) % 3 == 0 ? 0 : Bench_random() % 4;
+}
+
+static void make_periodic(unsigned char *buf, size_t size)
+{
+  /* A short pattern repeated with a period that doesn't divide the history
+     size, with an occasional change in one byte */
+  for (size_t i = 0; i < size; ++i)
+    buf[i] = (unsigned char)(i % 251 % 7) ^ (Bench_random() % 199 == 0);
+}
+
+static void make_random(unsigned char *buf, size_t size)
+{
+  /* Incompressible data, which requires the whole history to be searched
+     for every byte */
+  for (size_t i = 0; i < size; ++i)
+    buf[i] = Bench_random();
+}
+
+void Pathological_bench(void)
+{
+  static const struct
+  {
+    const char *input_name;
+    void (*make_func)(unsigned char *, size_t);
+  }
+  inputs[] =
+  {
+    { "Perturbed run", make_perturbed_run },
+    { "Small alphabet", make_small_alphabet },
+    { "Periodic", make_periodic },
+    { "Random", make_random },
+  };
+  static const unsigned int history_log_2s[] = { 9, 12, 16, 20, 24 };
+  static const GKeyCompMode modes[] = { GKeyCompMode_Best,
+                                        GKeyCompMode_Bounded };
+  unsigned char * const in = malloc(InputSize);
+  Bench_check_alloc(in);
+
+  for (size_t i = 0; i < ARRAY_SIZE(inputs); ++i)
+  {
+    inputs[i].make_func(in, InputSize);
+
+    for (size_t h = 0; h < ARRAY_SIZE(history_log_2s); ++h)
+    {
+      for (size_t m = 0; m < ARRAY_SIZE(modes); ++m)
+      {
+        const BenchResult result = Bench_compress(history_log_2s[h], modes[m],
+                                                  in, InputSize);
+        Bench_print(inputs[i].input_name, history_log_2s[h], modes[m],
+                    InputSize, result);
+      }
+    }
+  }
+
+  free(in);
+}
@@ -0,0 +1,239 @@
+/*
+ * GKeyLib benchmark: Ring buffer primitives
+ * Copyright (C) 2026 Christopher Bazley
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/* ISO library headers */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/* GKeyLib headers */
+#include "Internal/RingBuffer.h"
+
+/* Local headers */
+#include "Bench.h"
+
+enum
+{
+  HistoryLog2 = 12,
+  RingSize = 1 << HistoryLog2,
+  BytesPerCase = 1 << 22, /* Each operation is repeated until it has
+                             processed this many bytes */
+  MinCallsPerCase = 1 << 20, /* ...and at least this many times, so that
+                                the time taken is measurable */
+  Fill = 'x',
+  Absent = 'y'
+};
+
+typedef enum
+{
+  Place_Aligned, /* Operate on characters at the start of the buffer */
+  Place_Wrapped  /* Operate on characters straddling the end of the
+                    buffer (or the boundary between written and
+                    unwritten characters) */
+}
+Place;
+
+static volatile size_t sink;
+static unsigned char copied[RingSize];
+
+static size_t get_pos(Place place, size_t n)
+{
+  return place == Place_Wrapped ? RingSize - n / 2 : 0;
+}
+
+static void prepare(RingBuffer *ring, bool filled, size_t write_pos)
+{
+  /* Either every character has been written, or only those before the
+     write position */
+  static unsigned char fill[RingSize];
+
+  memset(fill, Fill, sizeof(fill));
+  RingBuffer_reset(ring);
+  if (filled)
+  {
+    RingBuffer_write(ring, fill, RingSize);
+    assert(ring->filled);
+    ring->write_pos = write_pos;
+  }
+  else
+  {
+    RingBuffer_write(ring, fill, write_pos);
+  }
+}
+
+static size_t get_reps(size_t n)
+{
+  return BytesPerCase / n > MinCallsPerCase ? BytesPerCase / n :
+                                              MinCallsPerCase;
+}
+
+static double seconds_since(clock_t start)
+{
+  return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+static double time_write(RingBuffer *ring, size_t n, Place place)
+{
+  static unsigned char src[RingSize];
+  const size_t pos = get_pos(place, n), reps = get_reps(n);
+
+  prepare(ring, true, pos);
+  const clock_t start = clock();
+
+  for (size_t r = 0; r < reps; ++r)
+  {
+    /* Keep writing at the same place */
+    ring->write_pos = pos;
+    RingBuffer_write(ring, src, n);
+  }
+
+  return seconds_since(start);
+}
+
+static size_t copy_cb(void *arg, const void *s, size_t n)
+{
+  /* Like the decompressor's callback, which copies characters to the
+     output buffer */
+  NOT_USED(arg);
+  memcpy(copied, s, n);
+  return n;
+}
+
+static double time_copy(RingBuffer *ring, size_t n, Place place,
+                        bool callback, size_t offset)
+{
+  const size_t pos = get_pos(place, n), reps = get_reps(n);
+  size_t total = 0;
+
+  prepare(ring, true, pos);
+  const clock_t start = clock();
+
+  for (size_t r = 0; r < reps; ++r)
+  {
+    ring->write_pos = pos;
+    total += RingBuffer_copy(ring, callback ? copy_cb : NULL, NULL,
+                             offset, n);
+  }
+
+  const double seconds = seconds_since(start);
+  sink = total;
+  return seconds;
+}
+
+static double time_find_char(RingBuffer *ring, size_t n, Place place,
+                             bool filled, int c)
+{
+  /* In an unfilled buffer, the search starts at the write position (the
+     first unwritten character) so that it covers characters which are
+     known to be zero without being read */
+  const size_t pos = place == Place_Aligned && !filled ? n :
+                                                         get_pos(place, n);
+  const size_t reps = get_reps(n);
+  size_t total = 0;
+
+  prepare(ring, filled, pos);
+  const clock_t start = clock();
+
+  for (size_t r = 0; r < reps; ++r)
+    total += RingBuffer_find_char(ring, 0, n, c);
+
+  const double seconds = seconds_since(start);
+  sink = total;
+  return seconds;
+}
+
+static double time_compare(RingBuffer *ring, size_t n, Place place,
+                           size_t offset)
+{
+  const size_t pos = get_pos(place, n), reps = get_reps(n);
+  int total = 0;
+
+  /* Every character is the same, so every comparison is of the whole
+     length */
+  prepare(ring, true, pos);
+  const clock_t start = clock();
+
+  for (size_t r = 0; r < reps; ++r)
+    total |= RingBuffer_compare(ring, offset, RingSize - n, n);
+
+  const double seconds = seconds_since(start);
+  sink = (size_t)total;
+  return seconds;
+}
+
+static void print_result(const char *op_name, const char *case_name,
+                         Place place, size_t n, double seconds)
+{
+  const size_t reps = get_reps(n);
+
+  printf("%-10s %-16s %-8s %5zu %10.2f %10.1f\n", op_name, case_name,
+         place == Place_Wrapped ? "wrapped" : "aligned", n,
+         seconds * 1e9 / reps,
+         seconds > 0 ? (double)reps * n / seconds / 1e6 : 0.0);
+}
+
+void Ring_bench(void)
+{
+  static const size_t lengths[] = { 1, 4, 16, 64, 256, 1024 };
+  RingBuffer * const ring = RingBuffer_make(HistoryLog2, NULL);
+  Bench_check_alloc(ring);
+
+  printf("%-10s %-16s %-8s %5s %10s %10s\n", "operation", "case", "place",
+         "n", "ns/call", "MB/s");
+
+  for (size_t l = 0; l < ARRAY_SIZE(lengths); ++l)
+  {
+    const size_t n = lengths[l];
+
+    for (Place place = Place_Aligned; place <= Place_Wrapped; ++place)
+    {
+      /* A single character can't straddle anything */
+      if (place == Place_Wrapped && n < 2)
+        continue;
+
+      print_result("write", "", place, n, time_write(ring, n, place));
+
+      print_result("copy", "oldest", place, n,
+                   time_copy(ring, n, place, false, 0));
+      print_result("copy", "newest", place, n,
+                   time_copy(ring, n, place, false, RingSize - n));
+      print_result("copy", "oldest callback", place, n,
+                   time_copy(ring, n, place, true, 0));
+      print_result("copy", "newest callback", place, n,
+                   time_copy(ring, n, place, true, RingSize - n));
+
+      print_result("find_char", "filled", place, n,
+                   time_find_char(ring, n, place, true, Absent));
+      print_result("find_char", "unfilled", place, n,
+                   time_find_char(ring, n, place, false, Absent));
+      print_result("find_char", "unfilled nul", place, n,
+                   time_find_char(ring, n, place, false, '\0'));
+
+      print_result("compare", "oldest", place, n,
+                   time_compare(ring, n, place, 0));
+      print_result("compare", "middle", place, n,
+                   time_compare(ring, n, place, RingSize / 2 - n));
+    }
+  }
+
+  RingBuffer_destroy(ring, NULL);
+}
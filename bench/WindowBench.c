@@ -0,0 +1,112 @@
+/*
+ * GKeyLib benchmark: Compression speed and ratio by history size
+ * Copyright (C) 2026 Christopher Bazley
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/* ISO library headers */
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+/* GKeyLib headers */
+#include "GKeyComp.h"
+
+/* Local headers */
+#include "Bench.h"
+
+enum
+{
+  InputSize = 1 << 22,
+  NumberOfWords = 512,
+  MaxWordSize = 12,
+  BlockSize = 1 << 14
+};
+
+static unsigned long random_below(unsigned long limit)
+{
+  unsigned long value = Bench_random();
+  value = (value << 8) | Bench_random();
+  value = (value << 8) | Bench_random();
+  return value % limit;
+}
+
+static void make_archive(unsigned char *buf, size_t size)
+{
+  /* Text made from a small vocabulary, interleaved with slightly modified
+     copies of blocks from anywhere earlier in the data, so that larger
+     histories find more matches */
+  static char words[NumberOfWords][MaxWordSize + 1];
+
+  for (size_t w = 0; w < NumberOfWords; ++w)
+  {
+    const size_t len = 2 + Bench_random() % (MaxWordSize - 1);
+    for (size_t i = 0; i < len; ++i)
+      words[w][i] = 'a' + Bench_random() % 26;
+    words[w][len] = '\0';
+  }
+
+  size_t pos = 0;
+  while (pos < size)
+  {
+    if (pos >= BlockSize && Bench_random() % 4 == 0)
+    {
+      const size_t src = random_below(pos - BlockSize + 1);
+      const size_t n = LOWEST(BlockSize, size - pos);
+      memcpy(buf + pos, buf + src, n);
+      for (size_t i = 0; i < n; i += 1 + random_below(n / 16))
+        buf[pos + i] = Bench_random();
+      pos += n;
+    }
+    else
+    {
+      for (size_t end = LOWEST(pos + BlockSize, size); pos < end; )
+      {
+        const char *const word = words[random_below(NumberOfWords)];
+        for (size_t i = 0; word[i] != '\0' && pos < end; ++i)
+          buf[pos++] = word[i];
+        if (pos < end)
+          buf[pos++] = ' ';
+      }
+    }
+  }
+}
+
+void Window_bench(void)
+{
+  static const unsigned int history_log_2s[] =
+  {
+    9, 12, 16, 17, 18, 20, 22, 24
+  };
+  static const GKeyCompMode modes[] = { GKeyCompMode_Best,
+                                        GKeyCompMode_Bounded };
+  unsigned char * const in = malloc(InputSize);
+  Bench_check_alloc(in);
+
+  make_archive(in, InputSize);
+
+  for (size_t h = 0; h < ARRAY_SIZE(history_log_2s); ++h)
+  {
+    for (size_t m = 0; m < ARRAY_SIZE(modes); ++m)
+    {
+      const BenchResult result = Bench_compress(history_log_2s[h], modes[m],
+                                                in, InputSize);
+      Bench_print("Archive", history_log_2s[h], modes[m], InputSize, result);
+    }
+  }
+
+  free(in);
+}
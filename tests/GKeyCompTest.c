@@ -19,10 +19,17 @@
 
 /* ISO library headers */
 #include <limits.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
 
 /* GKeyLib headers */
 #include "GKeyComp.h"
+#include "GKeyDecomp.h"
 
 /* Local headers */
 #include "Tests.h"
@@ -31,9 +38,162 @@ enum
 {
   NumberOfCompressors = 5,
   HistoryLog2 = 9,
-  FortifyAllocationLimit = 2048
+  FortifyAllocationLimit = 2048,
+  RunSize = 4096,
+  MixedSize = 4096,
+  BoundedHistoryLog2 = 14, /* Searched without an index or hash chains */
+  BoundedSize = 16384,
+  LargeHistoryLog2 = 17,
+  LargeSize = 16384,
+  StreamSize = 65536,
+  VecOutSize = 100,
+  VecMaxSegments = 64,
+  StageSize = 256,
+  StageInChunk = 3,
+  StageOutChunk = 10,
+  ProgressInterval = 1024,
+  DeadlineHistoryLog2 = 12,
+  DeadlineSize = 16384,
+  StatsHistoryLog2 = 12, /* Searched without an index or hash chains */
+  TraceSize = 4096,
+  TraceEventSize = 16,
+  ClockStepSeconds = 1, /* Time by which the fake clock advances when read */
+  ClockDeadlineSeconds = 8 /* Far more than enough processor time */
 };
 
+typedef struct
+{
+  size_t count, last_total, interval;
+}
+ProgressState;
+
+typedef struct
+{
+  size_t nallocs, nfrees;
+}
+AllocCounts;
+
+static void *counting_alloc(void *arg, size_t size)
+{
+  AllocCounts * const counts = arg;
+  void * const ptr = malloc(size);
+  if (ptr != NULL)
+    ++counts->nallocs;
+  return ptr;
+}
+
+static void counting_free(void *arg, void *ptr)
+{
+  AllocCounts * const counts = arg;
+  assert(ptr != NULL);
+  ++counts->nfrees;
+  free(ptr);
+}
+
+static void *failing_alloc(void *arg, size_t size)
+{
+  const bool * const fail = arg;
+  return *fail ? NULL : malloc(size);
+}
+
+static void failing_free(void *arg, void *ptr)
+{
+  NOT_USED(arg);
+  free(ptr);
+}
+
+typedef struct
+{
+  const unsigned char *in;
+  size_t in_size, in_pos, chunk_size;
+  unsigned char *out;
+  size_t out_size, out_pos;
+}
+StreamState;
+
+static bool stream_read(void *arg, void *buffer, size_t size, size_t *n)
+{
+  StreamState * const state = arg;
+  size_t to_read = state->in_size - state->in_pos;
+
+  if (to_read > size)
+    to_read = size;
+  if (to_read > state->chunk_size)
+    to_read = state->chunk_size;
+
+  memcpy(buffer, state->in + state->in_pos, to_read);
+  state->in_pos += to_read;
+  *n = to_read;
+  return true;
+}
+
+static bool stream_write(void *arg, const void *buffer, size_t n)
+{
+  StreamState * const state = arg;
+
+  if (n > state->out_size - state->out_pos)
+    return false;
+
+  memcpy(state->out + state->out_pos, buffer, n);
+  state->out_pos += n;
+  return true;
+}
+
+static bool count_progress(void *arg, size_t in, size_t out)
+{
+  ProgressState * const state = arg;
+
+  /* Progress must not be reported more often than requested */
+  if (state->count > 0)
+    assert(in + out - state->last_total >= state->interval);
+
+  ++state->count;
+  state->last_total = in + out;
+  return true;
+}
+
+static size_t compress_all(GKeyComp *comp, const void *in, size_t in_size,
+                           void *out, size_t out_size)
+{
+  GKeyParameters params = {
+    .in_buffer = in,
+    .in_size = in_size,
+    .out_buffer = out,
+    .out_size = out_size,
+  };
+
+  /* The first call consumes all of the input, and the second flushes */
+  GKeyStatus status = gkeycomp_compress(comp, &params);
+  assert(status == GKeyStatus_OK);
+  assert(params.in_size == 0);
+
+  status = gkeycomp_compress(comp, &params);
+  assert(status == GKeyStatus_Finished);
+
+  return out_size - params.out_size;
+}
+
+static void decompress_all(unsigned int history_log_2, const void *in,
+                           size_t in_size, void *out, size_t out_size)
+{
+  GKeyDecomp * const decomp = gkeydecomp_make(history_log_2);
+  assert(decomp != NULL);
+
+  GKeyParameters params = {
+    .in_buffer = in,
+    .in_size = in_size,
+    .out_buffer = out,
+    .out_size = out_size,
+  };
+
+  const GKeyStatus status = gkeydecomp_decompress(decomp, &params);
+  assert(status == GKeyStatus_OK);
+  assert(params.in_size == 0);
+  assert(params.out_size == 0);
+
+  gkeydecomp_destroy(decomp);
+}
+
 static void test1(void)
 {
   /* Make/destroy */
@@ -76,6 +236,1046 @@ static void test3(void)
   /* Destroy null */
   gkeycomp_destroy(NULL);
 }
+
+static void test4(void)
+{
+  /* Compress runs */
+  static unsigned char in[RunSize], out[RunSize], check[RunSize];
+  GKeyComp * const comp = gkeycomp_make(HistoryLog2);
+  assert(comp != NULL);
+
+  /* Zeros followed by a run of another value which is longer than the
+     ring buffer, then a few literals */
+  memset(in + RunSize / 4, 0xff, RunSize / 2);
+  memcpy(in + RunSize - 4, "abcd", 4);
+
+  const size_t out_size = compress_all(comp, in, sizeof(in),
+                                       out, sizeof(out));
+  assert(out_size < RunSize / 32);
+
+  decompress_all(HistoryLog2, out, out_size, check, sizeof(check));
+  assert(memcmp(in, check, sizeof(in)) == 0);
+
+  gkeycomp_destroy(comp);
+}
+
+static void test5(void)
+{
+  /* Adaptive mode */
+  static unsigned char in[MixedSize], out[MixedSize * 2], check[MixedSize];
+  static const char text[] = "The quick brown fox jumps over the lazy dog. ";
+  unsigned long seed = 1;
+  GKeyComp * const comp = gkeycomp_make(HistoryLog2);
+  assert(comp != NULL);
+
+  /* Pseudo-random data followed by repetitive text, which must still be
+     compressed after the compressor stops searching */
+  for (size_t i = 0; i < MixedSize / 2; ++i)
+  {
+    seed = seed * 1103515245ul + 12345ul;
+    in[i] = (unsigned char)(seed >> 16);
+  }
+  for (size_t i = MixedSize / 2; i < MixedSize; ++i)
+    in[i] = text[i % (sizeof(text) - 1)];
+
+  gkeycomp_set_mode(comp, GKeyCompMode_Adaptive);
+  const size_t out_size = compress_all(comp, in, sizeof(in),
+                                       out, sizeof(out));
+  assert(out_size < (MixedSize / 2) * (CHAR_BIT + 1) / CHAR_BIT +
+                    MixedSize / 16);
+
+  decompress_all(HistoryLog2, out, out_size, check, sizeof(check));
+  assert(memcmp(in, check, sizeof(in)) == 0);
+
+  /* The mode persists after a reset */
+  gkeycomp_reset(comp);
+  assert(compress_all(comp, in, sizeof(in), out, sizeof(out)) == out_size);
+
+  gkeycomp_destroy(comp);
+}
+
+static void test6(void)
+{
+  /* Bounded mode */
+  static unsigned char in[BoundedSize], out[BoundedSize * 2],
+                       check[BoundedSize];
+  unsigned long seed = 1;
+  GKeyCompStats best_stats, stats;
+  GKeyComp * const comp = gkeycomp_make(BoundedHistoryLog2);
+  assert(comp != NULL);
+
+  /* Random values from a small alphabet, interrupted by runs of zeros, in
+     a history too big to be searched exhaustively */
+  for (size_t i = 0; i < BoundedSize; ++i)
+  {
+    seed = seed * 1103515245ul + 12345ul;
+    in[i] = (i / 300) % 3 == 0 ? 0 : (unsigned char)((seed >> 16) % 4);
+  }
+
+  gkeycomp_set_stats(comp, &best_stats);
+  (void)compress_all(comp, in, sizeof(in), out, sizeof(out));
+
+  gkeycomp_reset(comp);
+  gkeycomp_set_mode(comp, GKeyCompMode_Bounded);
+  gkeycomp_set_stats(comp, &stats);
+  const size_t out_size = compress_all(comp, in, sizeof(in),
+                                       out, sizeof(out));
+  assert(out_size < BoundedSize);
+
+  /* Fewer bytes of history are searched than by GKeyCompMode_Best */
+  assert(stats.find_char_bytes < best_stats.find_char_bytes);
+  assert(stats.compare_bytes < best_stats.compare_bytes);
+  gkeycomp_set_stats(comp, NULL);
+
+  decompress_all(BoundedHistoryLog2, out, out_size, check, sizeof(check));
+  assert(memcmp(in, check, sizeof(in)) == 0);
+
+  gkeycomp_destroy(comp);
+}
+
+static void test7(void)
+{
+  /* Large history */
+  static unsigned char in[LargeSize], out[LargeSize * 2], check[LargeSize];
+  static const char text[] = "Chocks Away Stunt Racer 2000 Star Fighter 3000 ";
+  unsigned long seed = 1;
+  GKeyComp * const comp = gkeycomp_make(LargeHistoryLog2);
+  assert(comp != NULL);
+
+  /* Repetitive text with occasional errors */
+  for (size_t i = 0; i < LargeSize; ++i)
+  {
+    seed = seed * 1103515245ul + 12345ul;
+    in[i] = text[i % (sizeof(text) - 1)] ^ ((seed >> 16) % 97 == 0);
+  }
+
+  const size_t out_size = compress_all(comp, in, sizeof(in),
+                                       out, sizeof(out));
+  assert(out_size < LargeSize / 4);
+
+  decompress_all(LargeHistoryLog2, out, out_size, check, sizeof(check));
+  assert(memcmp(in, check, sizeof(in)) == 0);
+
+  /* Compress the same data one byte at a time */
+  gkeycomp_reset(comp);
+
+  GKeyParameters params = {
+    .out_buffer = out,
+    .out_size = sizeof(out),
+  };
+
+  for (size_t i = 0; i <= LargeSize; ++i)
+  {
+    params.in_buffer = in + i;
+    params.in_size = i < LargeSize ? 1 : 0;
+    const GKeyStatus status = gkeycomp_compress(comp, &params);
+    assert(status == (i < LargeSize ? GKeyStatus_OK : GKeyStatus_Finished));
+    assert(params.in_size == 0);
+  }
+
+  decompress_all(LargeHistoryLog2, out, sizeof(out) - params.out_size,
+                 check, sizeof(check));
+  assert(memcmp(in, check, sizeof(in)) == 0);
+
+  gkeycomp_destroy(comp);
+}
+
+static void test8(void)
+{
+  /* Allocator */
+  static const unsigned int history_log_2[] = {
+    HistoryLog2, BoundedHistoryLog2, LargeHistoryLog2
+  };
+  AllocCounts counts = {0, 0};
+  const GKeyAllocator allocator = { counting_alloc, counting_free, &counts };
+
+  for (size_t i = 0; i < ARRAY_SIZE(history_log_2); i++)
+  {
+    /* Per-compressor allocator */
+    GKeyComp *comp = gkeycomp_make_with_allocator(history_log_2[i],
+                                                  &allocator);
+    assert(comp != NULL);
+    assert(counts.nallocs > 0);
+    assert(counts.nfrees == 0);
+    gkeycomp_destroy(comp);
+    assert(counts.nfrees == counts.nallocs);
+
+    /* Default allocator, which must be used until the compressor is
+       destroyed even if the default is changed in the meantime */
+    counts.nallocs = counts.nfrees = 0;
+    GKey_set_allocator(&allocator);
+    comp = gkeycomp_make(history_log_2[i]);
+    GKey_set_allocator(NULL);
+    assert(comp != NULL);
+    assert(counts.nallocs > 0);
+    gkeycomp_destroy(comp);
+    assert(counts.nfrees == counts.nallocs);
+
+    /* Standard allocator */
+    counts.nallocs = counts.nfrees = 0;
+    comp = gkeycomp_make(history_log_2[i]);
+    assert(comp != NULL);
+    gkeycomp_destroy(comp);
+    assert(counts.nallocs == 0);
+  }
+}
+
+static void test9(void)
+{
+  /* Placement */
+  static const unsigned int history_log_2[] = {
+    HistoryLog2, BoundedHistoryLog2, LargeHistoryLog2
+  };
+  static unsigned char in[MixedSize], out[MixedSize * 2], check[MixedSize];
+  static const char text[] = "Tw2 Aww>ffvK4Cry8ZGKHJB";
+
+  for (size_t i = 0; i < MixedSize; ++i)
+    in[i] = text[(i * i) % (sizeof(text) - 1)];
+
+  for (size_t i = 0; i < ARRAY_SIZE(history_log_2); i++)
+  {
+    const size_t size = gkeycomp_state_size(history_log_2[i]);
+    void * const buffer = malloc(size);
+    assert(buffer != NULL);
+
+    assert(gkeycomp_init_in(buffer, size - 1, history_log_2[i]) == NULL);
+
+    GKeyComp * const comp = gkeycomp_init_in(buffer, size, history_log_2[i]);
+    assert(comp == buffer);
+
+    const size_t out_size = compress_all(comp, in, sizeof(in),
+                                         out, sizeof(out));
+    decompress_all(history_log_2[i], out, out_size, check, sizeof(check));
+    assert(memcmp(in, check, sizeof(in)) == 0);
+
+    /* The output must be the same as from an allocated compressor */
+    GKeyComp * const comp2 = gkeycomp_make(history_log_2[i]);
+    assert(comp2 != NULL);
+    assert(compress_all(comp2, in, sizeof(in), check, sizeof(check)) ==
+           out_size);
+    assert(memcmp(out, check, out_size) == 0);
+    gkeycomp_destroy(comp2);
+
+    gkeycomp_destroy(comp); /* does nothing */
+    free(buffer);
+  }
+}
+
+static void test10(void)
+{
+  /* Pool */
+  static unsigned char in[MixedSize], out[MixedSize * 2],
+                       check[MixedSize * 2];
+  GKeyPoolStats stats;
+
+  for (size_t i = 0; i < MixedSize; ++i)
+    in[i] = (unsigned char)((i * 7) ^ (i >> 5));
+
+  GKeyPool * const pool = gkeycomp_pool_make(HistoryLog2, 1, NULL, NULL);
+  assert(pool != NULL);
+
+  GKeyComp * const fresh = gkeycomp_make(HistoryLog2);
+  assert(fresh != NULL);
+  const size_t out_size = compress_all(fresh, in, sizeof(in),
+                                       out, sizeof(out));
+  gkeycomp_destroy(fresh);
+
+  GKeyComp * const comp = gkeycomp_pool_get(pool);
+  assert(comp != NULL);
+  gkeycomp_set_mode(comp, GKeyCompMode_Bounded);
+  compress_all(comp, in + 1, sizeof(in) - 1, check, sizeof(check));
+  gkeycomp_pool_put(pool, comp);
+
+  /* A reused compressor must behave as though newly created */
+  GKeyComp * const reused = gkeycomp_pool_get(pool);
+  assert(reused == comp);
+  assert(compress_all(reused, in, sizeof(in), check, sizeof(check)) ==
+         out_size);
+  assert(memcmp(out, check, out_size) == 0);
+
+  GKey_pool_get_stats(pool, &stats);
+  assert(stats.hits == 1);
+  assert(stats.misses == 1);
+  assert(stats.nfree == 0);
+
+  gkeycomp_pool_put(pool, reused);
+  GKey_pool_destroy(pool);
+}
+
+static void test11(void)
+{
+  /* Shared scratch */
+  static const unsigned int history_log_2[] = {
+    HistoryLog2, BoundedHistoryLog2, LargeHistoryLog2
+  };
+  enum { NumberOfStreams = 2, ChunkSize = 7 };
+  static unsigned char in[MixedSize],
+                       out[NumberOfStreams][MixedSize * 2],
+                       check[MixedSize * 2];
+  static const char text[] = "Chocks Away Stunt Racer 2000 Star Fighter 3000 ";
+
+  for (size_t i = 0; i < MixedSize; ++i)
+    in[i] = text[(i * i / 64) % (sizeof(text) - 1)];
+
+  for (size_t i = 0; i < ARRAY_SIZE(history_log_2); i++)
+  {
+    GKeyComp *comp[NumberOfStreams];
+    GKeyParameters params[NumberOfStreams];
+    GKeyPoolStats stats;
+
+    /* Only one scratch is kept, and the streams take turns to use it so
+       that each call must rebuild it */
+    GKeyPool * const pool = gkeycomp_scratch_pool_make(history_log_2[i], 1,
+                                                        NULL, NULL);
+    assert(pool != NULL);
+
+    for (size_t s = 0; s < NumberOfStreams; s++)
+    {
+      comp[s] = gkeycomp_make_shared(history_log_2[i], pool, NULL);
+      assert(comp[s] != NULL);
+      params[s] = (GKeyParameters){
+        .out_buffer = out[s],
+        .out_size = sizeof(out[s]),
+      };
+    }
+
+    for (size_t pos = 0; pos <= MixedSize; pos += ChunkSize)
+    {
+      for (size_t s = 0; s < NumberOfStreams; s++)
+      {
+        const size_t n = MixedSize - pos < ChunkSize ? MixedSize - pos :
+                         ChunkSize;
+        params[s].in_buffer = in + pos;
+        params[s].in_size = n;
+        const GKeyStatus status = gkeycomp_compress(comp[s], &params[s]);
+        assert(status == (n > 0 ? GKeyStatus_OK : GKeyStatus_Finished));
+        assert(params[s].in_size == 0);
+      }
+    }
+
+    GKey_pool_get_stats(pool, &stats);
+    assert(stats.misses <= 1);
+    assert(stats.nfree == stats.misses);
+
+    /* The output must be the same as from an unshared compressor */
+    GKeyComp * const unshared = gkeycomp_make(history_log_2[i]);
+    assert(unshared != NULL);
+    GKeyParameters uparams = {
+      .out_buffer = check,
+      .out_size = sizeof(check),
+    };
+    for (size_t pos = 0; pos <= MixedSize; pos += ChunkSize)
+    {
+      uparams.in_buffer = in + pos;
+      uparams.in_size = MixedSize - pos < ChunkSize ? MixedSize - pos :
+                        ChunkSize;
+      gkeycomp_compress(unshared, &uparams);
+    }
+    gkeycomp_destroy(unshared);
+
+    for (size_t s = 0; s < NumberOfStreams; s++)
+    {
+      assert(params[s].out_size == uparams.out_size);
+      assert(memcmp(out[s], check, sizeof(check) - uparams.out_size) == 0);
+      gkeycomp_destroy(comp[s]);
+    }
+
+    GKey_pool_destroy(pool);
+  }
+}
+
+static void test12(void)
+{
+  /* Stream */
+  static unsigned char in[StreamSize], out[StreamSize * 2],
+                       check[StreamSize * 2];
+  unsigned long seed = 1;
+  const GKeyStreamParameters sparams = {
+    .read_cb = stream_read,
+    .write_cb = stream_write,
+  };
+
+  /* Mostly incompressible so that the output exceeds the internal buffer */
+  for (size_t i = 0; i < StreamSize; ++i)
+  {
+    seed = seed * 1103515245ul + 12345ul;
+    in[i] = (i & 1024) ? (unsigned char)(seed >> 16) : (unsigned char)i;
+  }
+
+  GKeyComp * const comp = gkeycomp_make(HistoryLog2);
+  assert(comp != NULL);
+  const size_t out_size = compress_all(comp, in, sizeof(in),
+                                       check, sizeof(check));
+
+  /* The output must be the same as from gkeycomp_compress */
+  gkeycomp_reset(comp);
+  StreamState state = {
+    .in = in, .in_size = sizeof(in), .chunk_size = 1000,
+    .out = out, .out_size = sizeof(out)
+  };
+  GKeyStreamParameters p = sparams;
+  p.cb_arg = &state;
+  assert(gkeycomp_stream(comp, &p) == GKeyStatus_Finished);
+  assert(state.in_pos == sizeof(in));
+  assert(state.out_pos == out_size);
+  assert(memcmp(out, check, out_size) == 0);
+
+  /* Decompress the output in the same way */
+  GKeyDecomp * const decomp = gkeydecomp_make(HistoryLog2);
+  assert(decomp != NULL);
+  state = (StreamState){
+    .in = out, .in_size = out_size, .chunk_size = SIZE_MAX,
+    .out = check, .out_size = sizeof(check)
+  };
+  assert(gkeydecomp_stream(decomp, &p) == GKeyStatus_OK);
+  assert(state.out_pos == sizeof(in));
+  assert(memcmp(in, check, sizeof(in)) == 0);
+  gkeydecomp_destroy(decomp);
+
+  /* A failure to write output must abort compression */
+  gkeycomp_reset(comp);
+  state = (StreamState){
+    .in = in, .in_size = sizeof(in), .chunk_size = SIZE_MAX,
+    .out = out, .out_size = out_size / 2
+  };
+  assert(gkeycomp_stream(comp, &p) == GKeyStatus_Aborted);
+
+  gkeycomp_destroy(comp);
+}
+
+static void test13(void)
+{
+  /* Vectors */
+  static unsigned char in[MixedSize], out[MixedSize * 2], check[MixedSize * 2];
+  static const size_t in_sizes[] = { 1, 0, 5, 300, 2, 1000, 17 };
+  GKeyInVec in_vec[ARRAY_SIZE(in_sizes) + 1];
+  GKeyOutVec out_vec[VecMaxSegments];
+  GKeyVecParameters params = { 0 };
+  size_t pos = 0;
+
+  for (size_t i = 0; i < sizeof(in); ++i)
+    in[i] = (unsigned char)((i % 7) * (i / 128));
+
+  GKeyComp * const comp = gkeycomp_make(HistoryLog2);
+  assert(comp != NULL);
+  const size_t out_size = compress_all(comp, in, sizeof(in),
+                                       check, sizeof(check));
+
+  /* Split the input into segments of varying sizes, with the remainder in
+     the last segment */
+  for (size_t i = 0; i < ARRAY_SIZE(in_sizes); ++i)
+  {
+    in_vec[i] = (GKeyInVec){ in + pos, in_sizes[i] };
+    pos += in_sizes[i];
+  }
+  in_vec[ARRAY_SIZE(in_sizes)] = (GKeyInVec){ in + pos, sizeof(in) - pos };
+
+  for (size_t i = 0; i < ARRAY_SIZE(out_vec); ++i)
+    out_vec[i] = (GKeyOutVec){ out + i * VecOutSize, VecOutSize };
+
+  /* The output must be the same as from gkeycomp_compress */
+  gkeycomp_reset(comp);
+  params.in_vec = in_vec;
+  params.in_count = ARRAY_SIZE(in_vec);
+  params.out_vec = out_vec;
+  params.out_count = ARRAY_SIZE(out_vec);
+  assert(gkeycomp_compress_vec(comp, &params) == GKeyStatus_OK);
+  assert(params.in_count == 0);
+
+  params.in_count = 0;
+  assert(gkeycomp_compress_vec(comp, &params) == GKeyStatus_Finished);
+  assert(ARRAY_SIZE(out_vec) - params.out_count ==
+         out_size / VecOutSize);
+  assert(params.out_offset == out_size % VecOutSize);
+  assert(memcmp(out, check, out_size) == 0);
+
+  /* Running out of output segments must be reported */
+  gkeycomp_reset(comp);
+  params = (GKeyVecParameters){
+    .in_vec = in_vec, .in_count = ARRAY_SIZE(in_vec),
+    .out_vec = out_vec, .out_count = 2
+  };
+  assert(gkeycomp_compress_vec(comp, &params) == GKeyStatus_BufferOverflow);
+  assert(params.out_count == 0);
+  assert(memcmp(out, check, VecOutSize * 2) == 0);
+
+  gkeycomp_destroy(comp);
+}
+
+static void test14(void)
+{
+  /* Staging */
+  static unsigned char in[MixedSize], out[MixedSize * 2], check[MixedSize * 2];
+  static const char text[] = "The quick brown fox jumps over the lazy dog. ";
+  size_t out_pos = 0;
+  GKeyStatus status;
+
+  for (size_t i = 0; i < sizeof(in); ++i)
+    in[i] = text[(i * i) % (sizeof(text) - 1)];
+
+  GKeyComp * const comp = gkeycomp_make(HistoryLog2);
+  assert(comp != NULL);
+  const size_t out_size = compress_all(comp, in, sizeof(in),
+                                       check, sizeof(check));
+
+  /* Small inputs and outputs must produce the same output as one call */
+  gkeycomp_reset(comp);
+  assert(gkeycomp_set_staging(comp, StageSize));
+
+  GKeyParameters params = { .out_buffer = out, .out_size = StageOutChunk };
+  for (size_t in_pos = 0; in_pos < sizeof(in); )
+  {
+    params.in_buffer = in + in_pos;
+    params.in_size = sizeof(in) - in_pos;
+    if (params.in_size > StageInChunk)
+      params.in_size = StageInChunk;
+    in_pos += params.in_size;
+    do
+    {
+      status = gkeycomp_compress(comp, &params);
+      if (status == GKeyStatus_BufferOverflow)
+        params.out_size = StageOutChunk;
+      else
+        assert(status == GKeyStatus_OK);
+    }
+    while (params.in_size > 0 || status != GKeyStatus_OK);
+  }
+  do
+  {
+    status = gkeycomp_compress(comp, &params);
+    if (status == GKeyStatus_BufferOverflow)
+      params.out_size = StageOutChunk;
+  }
+  while (status == GKeyStatus_BufferOverflow);
+  assert(status == GKeyStatus_Finished);
+
+  out_pos = (size_t)((unsigned char *)params.out_buffer - out);
+  assert(out_pos == out_size);
+  assert(memcmp(out, check, out_size) == 0);
+
+  /* Staging is not possible without an allocator */
+  const size_t size = gkeycomp_state_size(HistoryLog2);
+  void * const buffer = malloc(size);
+  assert(buffer != NULL);
+  GKeyComp * const placed = gkeycomp_init_in(buffer, size, HistoryLog2);
+  assert(placed != NULL);
+  assert(!gkeycomp_set_staging(placed, StageSize));
+  assert(gkeycomp_set_staging(placed, 0));
+  free(buffer);
+
+  gkeycomp_destroy(comp);
+}
+
+static void test15(void)
+{
+  /* Progress interval */
+  static unsigned char in[MixedSize], out[MixedSize * 2], check[MixedSize * 2];
+  static const char text[] = "The quick brown fox jumps over the lazy dog. ";
+  volatile sig_atomic_t cancel = 0;
+  ProgressState state = { 0 };
+
+  for (size_t i = 0; i < sizeof(in); ++i)
+    in[i] = text[(i * i) % (sizeof(text) - 1)];
+
+  GKeyComp * const comp = gkeycomp_make(HistoryLog2);
+  assert(comp != NULL);
+
+  GKeyParameters params = {
+    .in_buffer = in, .in_size = sizeof(in),
+    .out_buffer = check, .out_size = sizeof(check),
+    .prog_cb = count_progress, .cb_arg = &state
+  };
+  assert(gkeycomp_compress(comp, &params) == GKeyStatus_OK);
+  assert(gkeycomp_compress(comp, &params) == GKeyStatus_Finished);
+  const size_t out_size = sizeof(check) - params.out_size;
+  const size_t every_count = state.count;
+
+  /* Reporting progress less often must not change the output */
+  gkeycomp_reset(comp);
+  gkeycomp_set_progress(comp, ProgressInterval, &cancel);
+  state = (ProgressState){ .interval = ProgressInterval };
+  params = (GKeyParameters){
+    .in_buffer = in, .in_size = sizeof(in),
+    .out_buffer = out, .out_size = sizeof(out),
+    .prog_cb = count_progress, .cb_arg = &state
+  };
+  assert(gkeycomp_compress(comp, &params) == GKeyStatus_OK);
+  assert(gkeycomp_compress(comp, &params) == GKeyStatus_Finished);
+  assert(state.count > 1);
+  assert(state.count <= (sizeof(in) + out_size) / ProgressInterval + 1);
+  assert(state.count < every_count);
+  assert(sizeof(out) - params.out_size == out_size);
+  assert(memcmp(out, check, out_size) == 0);
+
+  /* Setting the flag must abort compression until it is cleared */
+  gkeycomp_reset(comp);
+  params = (GKeyParameters){
+    .in_buffer = in, .in_size = sizeof(in),
+    .out_buffer = out, .out_size = sizeof(out)
+  };
+  cancel = 1;
+  assert(gkeycomp_compress(comp, &params) == GKeyStatus_Aborted);
+  assert(params.in_size == sizeof(in));
+  cancel = 0;
+  assert(gkeycomp_compress(comp, &params) == GKeyStatus_OK);
+  assert(gkeycomp_compress(comp, &params) == GKeyStatus_Finished);
+  assert(memcmp(out, check, out_size) == 0);
+
+  gkeycomp_destroy(comp);
+}
+
+static void test16(void)
+{
+  /* Deadline */
+  static unsigned char in[DeadlineSize], out[DeadlineSize * 2],
+                       check[DeadlineSize * 2];
+  static const char text[] = "The quick brown fox jumps over the lazy dog. ";
+
+  for (size_t i = 0; i < sizeof(in); ++i)
+    in[i] = text[(i * i) % (sizeof(text) - 1)];
+
+  GKeyComp * const comp = gkeycomp_make(DeadlineHistoryLog2);
+  assert(comp != NULL);
+  const size_t best_size = compress_all(comp, in, sizeof(in),
+                                        check, sizeof(check));
+
+  /* A generous deadline must not reduce the effort */
+  gkeycomp_reset(comp);
+  gkeycomp_set_mode(comp, GKeyCompMode_Deadline);
+  gkeycomp_set_deadline(comp, sizeof(in), (clock_t)CLOCKS_PER_SEC * 3600);
+  assert(compress_all(comp, in, sizeof(in), out, sizeof(out)) == best_size);
+  assert(memcmp(out, check, best_size) == 0);
+
+  /* An impossible deadline gives worse compression */
+  gkeycomp_reset(comp);
+  gkeycomp_set_deadline(comp, sizeof(in), 0);
+  const size_t out_size = compress_all(comp, in, sizeof(in),
+                                       out, sizeof(out));
+  assert(out_size > best_size);
+
+  decompress_all(DeadlineHistoryLog2, out, out_size, check, sizeof(in));
+  assert(memcmp(in, check, sizeof(in)) == 0);
+
+  gkeycomp_destroy(comp);
+}
+
+static void test17(void)
+{
+  /* Verify */
+  static unsigned char in[BoundedSize], out[BoundedSize * 2],
+                       check[BoundedSize * 2];
+  static const char text[] = "The quick brown fox jumps over the lazy dog. ";
+  static const unsigned int history_log_2[] = { HistoryLog2,
+                                                 BoundedHistoryLog2 };
+  GKeyStatus status;
+
+  for (size_t i = 0; i < sizeof(in); ++i)
+    in[i] = text[(i * i) % (sizeof(text) - 1)];
+
+  for (size_t h = 0; h < ARRAY_SIZE(history_log_2); ++h)
+  {
+    GKeyComp * const comp = gkeycomp_make(history_log_2[h]);
+    assert(comp != NULL);
+    const size_t out_size = compress_all(comp, in, sizeof(in),
+                                         check, sizeof(check));
+
+    /* Verification must not change the output, even if it is produced a
+       few bytes at a time */
+    gkeycomp_reset(comp);
+    assert(gkeycomp_set_verify(comp, true));
+
+    GKeyParameters params = {
+      .in_buffer = in, .in_size = sizeof(in),
+      .out_buffer = out, .out_size = StageOutChunk
+    };
+    do
+    {
+      status = gkeycomp_compress(comp, &params);
+      if (status == GKeyStatus_BufferOverflow)
+        params.out_size = StageOutChunk;
+      else if (status == GKeyStatus_OK)
+        assert(params.in_size == 0);
+    }
+    while (status == GKeyStatus_BufferOverflow || status == GKeyStatus_OK);
+    assert(status == GKeyStatus_Finished);
+
+    assert((size_t)((unsigned char *)params.out_buffer - out) == out_size);
+    assert(memcmp(out, check, out_size) == 0);
+
+    /* Verification persists across a reset */
+    gkeycomp_reset(comp);
+    assert(compress_all(comp, in, sizeof(in), out, sizeof(out)) == out_size);
+    assert(memcmp(out, check, out_size) == 0);
+
+    gkeycomp_reset(comp);
+    assert(gkeycomp_set_verify(comp, false));
+    gkeycomp_destroy(comp);
+  }
+
+  /* Verification is not possible without an allocator */
+  const size_t size = gkeycomp_state_size(HistoryLog2);
+  void * const buffer = malloc(size);
+  assert(buffer != NULL);
+  GKeyComp * const placed = gkeycomp_init_in(buffer, size, HistoryLog2);
+  assert(placed != NULL);
+  assert(!gkeycomp_set_verify(placed, true));
+  assert(gkeycomp_set_verify(placed, false));
+  free(buffer);
+}
+
+static void test18(void)
+{
+  /* Statistics */
+  static unsigned char in[MixedSize], out[MixedSize * 2], check[MixedSize * 2];
+  static const char text[] = "The quick brown fox jumps over the lazy dog. ";
+  GKeyCompStats stats;
+  GKeyDecompStats dstats;
+  size_t binned = 0;
+
+  for (size_t i = 0; i < sizeof(in); ++i)
+    in[i] = text[(i * i) % (sizeof(text) - 1)];
+
+  GKeyComp * const comp = gkeycomp_make(StatsHistoryLog2);
+  assert(comp != NULL);
+  const size_t out_size = compress_all(comp, in, sizeof(in),
+                                       check, sizeof(check));
+
+  /* Collecting statistics must not change the output */
+  gkeycomp_reset(comp);
+  gkeycomp_set_stats(comp, &stats);
+  assert(compress_all(comp, in, sizeof(in), out, sizeof(out)) == out_size);
+  assert(memcmp(out, check, out_size) == 0);
+
+  assert(stats.copies > 0);
+  assert(stats.literals > 0);
+  assert(stats.short_sizes + stats.full_sizes == stats.copies);
+  for (size_t i = 0; i < ARRAY_SIZE(stats.lengths); ++i)
+    binned += stats.lengths[i];
+  assert(binned == stats.copies);
+  assert(stats.searches >= stats.copies);
+  assert(stats.find_char_bytes > 0);
+  assert(stats.compare_bytes > 0);
+
+  /* The decompressor must decode the same commands */
+  GKeyDecomp * const decomp = gkeydecomp_make(StatsHistoryLog2);
+  assert(decomp != NULL);
+  gkeydecomp_set_stats(decomp, &dstats);
+  GKeyParameters params = {
+    .in_buffer = out, .in_size = out_size,
+    .out_buffer = check, .out_size = sizeof(in)
+  };
+  assert(gkeydecomp_decompress(decomp, &params) == GKeyStatus_OK);
+  assert(memcmp(in, check, sizeof(in)) == 0);
+  assert(dstats.literals == stats.literals);
+  assert(dstats.copies == stats.copies);
+  assert(dstats.literals + dstats.copy_bytes == sizeof(in));
+  gkeydecomp_destroy(decomp);
+
+  /* Input consumed a byte at a time causes stalls */
+  gkeycomp_reset(comp);
+  gkeycomp_set_stats(comp, &stats);
+  params = (GKeyParameters){ .out_buffer = out, .out_size = sizeof(out) };
+  for (size_t i = 0; i < sizeof(in); ++i)
+  {
+    params.in_buffer = in + i;
+    params.in_size = 1;
+    assert(gkeycomp_compress(comp, &params) == GKeyStatus_OK);
+  }
+  assert(gkeycomp_compress(comp, &params) == GKeyStatus_Finished);
+  assert(sizeof(out) - params.out_size == out_size);
+  assert(stats.stalls > 0);
+
+  gkeycomp_set_stats(comp, NULL);
+  gkeycomp_destroy(comp);
+}
+
+static void test19(void)
+{
+  /* Trace */
+  static unsigned char in[MixedSize], out[MixedSize * 2], check[MixedSize * 2];
+  static unsigned char saved[TraceEventSize * (TraceSize + 1)];
+  static GKeyTraceEvent events[TraceSize];
+  static const char text[] = "The quick brown fox jumps over the lazy dog. ";
+  GKeyTrace trace;
+  GKeyCompStats stats;
+  size_t ncopies = 0, ndecoded = 0;
+
+  for (size_t i = 0; i < sizeof(in); ++i)
+    in[i] = text[(i * i) % (sizeof(text) - 1)];
+
+  GKeyComp * const comp = gkeycomp_make(HistoryLog2);
+  assert(comp != NULL);
+  const size_t out_size = compress_all(comp, in, sizeof(in),
+                                       check, sizeof(check));
+
+  /* Tracing must not change the output */
+  GKey_trace_init(&trace, events, ARRAY_SIZE(events));
+  gkeycomp_reset(comp);
+  gkeycomp_set_trace(comp, &trace);
+  gkeycomp_set_stats(comp, &stats);
+  assert(compress_all(comp, in, sizeof(in), out, sizeof(out)) == out_size);
+  assert(memcmp(out, check, out_size) == 0);
+  gkeycomp_set_trace(comp, NULL);
+
+  /* Each call is bracketed by events, and the decisions to put copy
+     commands are recorded */
+  assert(trace.count > 4 && trace.count < ARRAY_SIZE(events));
+  assert(events[0].type == GKeyTraceType_Call);
+  assert(events[0].source == GKeyTraceSource_Comp);
+  assert(events[0].arg1 == sizeof(in));
+  assert(events[trace.count - 1].type == GKeyTraceType_Return);
+  assert(events[trace.count - 1].arg1 == GKeyStatus_Finished);
+  for (size_t i = 0; i < trace.count; ++i)
+  {
+    if (events[i].type == GKeyTraceType_Copy)
+      ++ncopies;
+  }
+  assert(ncopies == stats.copies);
+
+  /* A decompressor can record events in the same ring */
+  const size_t comp_count = trace.count;
+  GKeyDecomp * const decomp = gkeydecomp_make(HistoryLog2);
+  assert(decomp != NULL);
+  gkeydecomp_set_trace(decomp, &trace);
+  GKeyParameters params = {
+    .in_buffer = out, .in_size = out_size,
+    .out_buffer = check, .out_size = sizeof(in)
+  };
+  assert(gkeydecomp_decompress(decomp, &params) == GKeyStatus_OK);
+  gkeydecomp_destroy(decomp);
+  for (size_t i = comp_count; i < trace.count; ++i)
+  {
+    assert(events[i].source == GKeyTraceSource_Decomp);
+    if (events[i].type == GKeyTraceType_Copy)
+      ++ndecoded;
+  }
+  assert(ndecoded == ncopies);
+
+  /* Only the most recent events are saved once the ring is full */
+  trace.count = TraceSize * 3 + 5;
+  StreamState state = { .out = saved, .out_size = sizeof(saved) };
+  assert(GKey_trace_save(&trace, stream_write, &state));
+  assert(state.out_pos == TraceEventSize * (TraceSize + 1));
+  assert(memcmp(saved, "GKTR", 4) == 0);
+  assert(saved[16] == events[5].type);
+
+  /* Write errors must be reported */
+  state = (StreamState){ .out = saved, .out_size = TraceEventSize };
+  assert(!GKey_trace_save(&trace, stream_write, &state));
+
+  gkeycomp_set_stats(comp, NULL);
+  gkeycomp_destroy(comp);
+}
+
+static void test20(void)
+{
+  /* Scratch unavailable */
+  static const unsigned int history_log_2[] = {
+    HistoryLog2, LargeHistoryLog2
+  };
+  enum { ChunkSize = 7, Period = 300 };
+  static unsigned char in[LargeSize], out[LargeSize * 2], check[LargeSize];
+  unsigned long seed = 1;
+  bool fail = false;
+  const GKeyAllocator allocator = { failing_alloc, failing_free, &fail };
+
+  /* A long repeated sequence, so that searches using the scratch memory
+     stall while extending a sequence and the next search (without it)
+     could extend the same sequence beyond the maximum size */
+  for (size_t i = 0; i < LargeSize; ++i)
+  {
+    seed = seed * 1103515245ul + 12345ul;
+    in[i] = i < Period ? (unsigned char)(seed >> 16) : in[i - Period];
+  }
+
+  for (size_t i = 0; i < ARRAY_SIZE(history_log_2); i++)
+  {
+    /* No scratch is kept, so every other call can't get any and must
+       continue the search started by the previous call without it */
+    GKeyPool * const pool = gkeycomp_scratch_pool_make(history_log_2[i], 0,
+                                                        &allocator, NULL);
+    assert(pool != NULL);
+
+    GKeyComp * const comp = gkeycomp_make_shared(history_log_2[i], pool,
+                                                 NULL);
+    assert(comp != NULL);
+
+    GKeyParameters params = {
+      .out_buffer = out,
+      .out_size = sizeof(out),
+    };
+
+    GKeyStatus status;
+    size_t pos = 0, n;
+    do
+    {
+      n = LargeSize - pos < ChunkSize ? LargeSize - pos : ChunkSize;
+      params.in_buffer = in + pos;
+      params.in_size = n;
+      status = gkeycomp_compress(comp, &params);
+      assert(status == (n > 0 ? GKeyStatus_OK : GKeyStatus_Finished));
+      pos += n;
+      fail = !fail;
+    }
+    while (n > 0);
+    fail = false;
+
+    decompress_all(history_log_2[i], out, sizeof(out) - params.out_size,
+                   check, sizeof(check));
+    assert(memcmp(in, check, sizeof(in)) == 0);
+
+    gkeycomp_destroy(comp);
+    GKey_pool_destroy(pool);
+  }
+}
+
+static clock_t fake_clock(void *arg)
+{
+  clock_t * const now = arg;
+  const clock_t then = *now;
+
+  *now += (clock_t)CLOCKS_PER_SEC * ClockStepSeconds;
+  return then;
+}
+
+static void test21(void)
+{
+  /* Clock */
+  static unsigned char in[DeadlineSize], out[DeadlineSize * 2],
+                       check[DeadlineSize * 2];
+  static const char text[] = "The quick brown fox jumps over the lazy dog. ";
+  clock_t now = 0;
+  GKeyCompStats stats;
+
+  for (size_t i = 0; i < sizeof(in); ++i)
+    in[i] = text[(i * i) % (sizeof(text) - 1)];
+
+  GKeyComp * const comp = gkeycomp_make(DeadlineHistoryLog2);
+  assert(comp != NULL);
+  const size_t best_size = compress_all(comp, in, sizeof(in),
+                                        check, sizeof(check));
+
+  /* A deadline that is generous in processor time can be missed if the
+     clock runs fast */
+  gkeycomp_reset(comp);
+  gkeycomp_set_mode(comp, GKeyCompMode_Deadline);
+  gkeycomp_set_deadline(comp, sizeof(in),
+                        (clock_t)CLOCKS_PER_SEC * ClockDeadlineSeconds);
+  gkeycomp_set_clock(comp, fake_clock, &now);
+  const size_t out_size = compress_all(comp, in, sizeof(in),
+                                       out, sizeof(out));
+  assert(out_size > best_size);
+  assert(now > 0);
+
+  decompress_all(DeadlineHistoryLog2, out, out_size, check, sizeof(in));
+  assert(memcmp(in, check, sizeof(in)) == 0);
+
+  /* The clock persists across a reset and is used for statistics */
+  gkeycomp_reset(comp);
+  gkeycomp_set_mode(comp, GKeyCompMode_Best);
+  gkeycomp_set_stats(comp, &stats);
+  now = 0;
+  assert(compress_all(comp, in, sizeof(in), out, sizeof(out)) == best_size);
+  assert(stats.total_ticks > 0);
+  assert(stats.total_ticks %
+         ((clock_t)CLOCKS_PER_SEC * ClockStepSeconds) == 0);
+  assert(stats.total_ticks < now);
+  gkeycomp_set_stats(comp, NULL);
+
+  /* The default clock is restored by passing a null pointer */
+  gkeycomp_reset(comp);
+  gkeycomp_set_mode(comp, GKeyCompMode_Deadline);
+  gkeycomp_set_deadline(comp, sizeof(in), (clock_t)CLOCKS_PER_SEC * 3600);
+  gkeycomp_set_clock(comp, NULL, NULL);
+  now = 0;
+  assert(compress_all(comp, in, sizeof(in), out, sizeof(out)) == best_size);
+  assert(now == 0);
+
+  gkeycomp_destroy(comp);
+}
+
+static void test22(void)
+{
+  /* Index matches linear search */
+  static const size_t chunk_sizes[] = { 1, 7, MixedSize };
+  static unsigned char in[MixedSize], out[MixedSize * 2],
+                       check[MixedSize * 2];
+  static const char text[] = "The quick brown fox jumps over the lazy dog. ";
+  unsigned long seed = 1;
+  bool fail = false;
+  const GKeyAllocator allocator = { failing_alloc, failing_free, &fail };
+
+  /* Quarters of pseudo-random data, text with errors, runs from a small
+     alphabet and a periodic pattern */
+  for (size_t i = 0; i < MixedSize; ++i)
+  {
+    seed = seed * 1103515245ul + 12345ul;
+    switch (i / (MixedSize / 4))
+    {
+      case 0:
+        in[i] = (unsigned char)(seed >> 16);
+        break;
+      case 1:
+        in[i] = text[i % (sizeof(text) - 1)] ^ ((seed >> 16) % 23 == 0);
+        break;
+      case 2:
+        in[i] = (i / 30) % 3 == 0 ? 0 : (unsigned char)((seed >> 16) % 4);
+        break;
+      default:
+        in[i] = (unsigned char)((i % 17) * (i % 5));
+        break;
+    }
+  }
+
+  for (unsigned int h = 0; h <= HistoryLog2; ++h)
+  {
+    /* A compressor that can't borrow an index searches the history
+       without one, which gives the expected output */
+    GKeyPool * const pool = gkeycomp_scratch_pool_make(h, 0, &allocator,
+                                                       NULL);
+    assert(pool != NULL);
+    GKeyComp * const linear = gkeycomp_make_shared(h, pool, NULL);
+    assert(linear != NULL);
+    fail = true;
+    const size_t out_size = compress_all(linear, in, sizeof(in),
+                                         check, sizeof(check));
+    fail = false;
+    gkeycomp_destroy(linear);
+    GKey_pool_destroy(pool);
+
+    GKeyComp * const comp = gkeycomp_make(h);
+    assert(comp != NULL);
+
+    for (size_t c = 0; c < ARRAY_SIZE(chunk_sizes); ++c)
+    {
+      GKeyParameters params = {
+        .out_buffer = out,
+        .out_size = sizeof(out),
+      };
+      GKeyStatus status;
+      size_t pos = 0, n;
+
+      gkeycomp_reset(comp);
+      do
+      {
+        n = sizeof(in) - pos < chunk_sizes[c] ? sizeof(in) - pos :
+                                                chunk_sizes[c];
+        params.in_buffer = in + pos;
+        params.in_size = n;
+        status = gkeycomp_compress(comp, &params);
+        assert(status == (n > 0 ? GKeyStatus_OK : GKeyStatus_Finished));
+        pos += n;
+      }
+      while (n > 0);
+
+      assert(sizeof(out) - params.out_size == out_size);
+      assert(memcmp(out, check, out_size) == 0);
+    }
+
+    gkeycomp_destroy(comp);
+  }
+}
+
 void GKeyComp_tests(void)
 {
   static const struct
@@ -88,6 +1288,25 @@ void GKeyComp_tests(void)
     { "Make/destroy", test1 },
     { "Make fail recovery", test2 },
     { "Destroy null", test3 },
+    { "Compress runs", test4 },
+    { "Adaptive mode", test5 },
+    { "Bounded mode", test6 },
+    { "Large history", test7 },
+    { "Allocator", test8 },
+    { "Placement", test9 },
+    { "Pool", test10 },
+    { "Shared scratch", test11 },
+    { "Stream", test12 },
+    { "Vectors", test13 },
+    { "Staging", test14 },
+    { "Progress interval", test15 },
+    { "Deadline", test16 },
+    { "Verify", test17 },
+    { "Statistics", test18 },
+    { "Trace", test19 },
+    { "Scratch unavailable", test20 },
+    { "Clock", test21 },
+    { "Index matches linear search", test22 },
   };
 
   for (size_t count = 0; count < ARRAY_SIZE(unit_tests); count ++)
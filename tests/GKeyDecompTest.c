@@ -19,7 +19,11 @@
 
 /* ISO library headers */
 #include <limits.h>
+#include <signal.h>
+#include <stdbool.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 /* GKeyLib headers */
 #include "GKeyDecomp.h"
@@ -31,9 +35,70 @@ enum
 {
   NumberOfDecompressors = 5,
   HistoryLog2 = 9,
+  PlacementSize = 1024,
   FortifyAllocationLimit = 2048
 };
 
+typedef struct
+{
+  size_t nallocs, nfrees;
+}
+AllocCounts;
+
+static void *counting_alloc(void *arg, size_t size)
+{
+  AllocCounts * const counts = arg;
+  void * const ptr = malloc(size);
+  if (ptr != NULL)
+    ++counts->nallocs;
+  return ptr;
+}
+
+static void counting_free(void *arg, void *ptr)
+{
+  AllocCounts * const counts = arg;
+  assert(ptr != NULL);
+  ++counts->nfrees;
+  free(ptr);
+}
+
+typedef struct
+{
+  const unsigned char *in;
+  size_t in_size, in_pos, chunk_size;
+  unsigned char *out;
+  size_t out_size, out_pos;
+}
+StreamState;
+
+static bool stream_read(void *arg, void *buffer, size_t size, size_t *n)
+{
+  StreamState * const state = arg;
+  size_t to_read = state->in_size - state->in_pos;
+
+  if (to_read > size)
+    to_read = size;
+  if (to_read > state->chunk_size)
+    to_read = state->chunk_size;
+
+  memcpy(buffer, state->in + state->in_pos, to_read);
+  state->in_pos += to_read;
+  *n = to_read;
+  return true;
+}
+
+static bool stream_write(void *arg, const void *buffer, size_t n)
+{
+  StreamState * const state = arg;
+
+  if (n > state->out_size - state->out_pos)
+    return false;
+
+  memcpy(state->out + state->out_pos, buffer, n);
+  state->out_pos += n;
+  return true;
+}
+
 static void test1(void)
 {
   /* Make/destroy */
@@ -76,6 +141,354 @@ static void test3(void)
   /* Destroy null */
   gkeydecomp_destroy(NULL);
 }
+static void test4(void)
+{
+  /* Allocator */
+  AllocCounts counts = {0, 0};
+  const GKeyAllocator allocator = { counting_alloc, counting_free, &counts };
+
+  /* Per-decompressor allocator */
+  GKeyDecomp *decomp = gkeydecomp_make_with_allocator(HistoryLog2,
+                                                      &allocator);
+  assert(decomp != NULL);
+  assert(counts.nallocs > 0);
+  assert(counts.nfrees == 0);
+  gkeydecomp_destroy(decomp);
+  assert(counts.nfrees == counts.nallocs);
+
+  /* Default allocator, which must be used until the decompressor is
+     destroyed even if the default is changed in the meantime */
+  counts.nallocs = counts.nfrees = 0;
+  GKey_set_allocator(&allocator);
+  decomp = gkeydecomp_make(HistoryLog2);
+  GKey_set_allocator(NULL);
+  assert(decomp != NULL);
+  assert(counts.nallocs > 0);
+  gkeydecomp_destroy(decomp);
+  assert(counts.nfrees == counts.nallocs);
+
+  /* Standard allocator */
+  counts.nallocs = counts.nfrees = 0;
+  decomp = gkeydecomp_make(HistoryLog2);
+  assert(decomp != NULL);
+  gkeydecomp_destroy(decomp);
+  assert(counts.nallocs == 0);
+}
+
+static void test5(void)
+{
+  /* Placement */
+  static union
+  {
+    long double ld;
+    void *p;
+    unsigned char bytes[PlacementSize];
+  }
+  buffer;
+  /* "ABABABAB" compressed with HistoryLog2 */
+  static const unsigned char in[] = {
+    0x82, 0x08, 0x09, 0x22, 0x94, 0xff, 0x00, 0x21
+  };
+  char out[8];
+
+  const size_t size = gkeydecomp_state_size(HistoryLog2);
+  assert(size <= sizeof(buffer));
+  assert(gkeydecomp_init_in(&buffer, size - 1, HistoryLog2) == NULL);
+
+  GKeyDecomp * const decomp = gkeydecomp_init_in(&buffer, size, HistoryLog2);
+  assert(decomp == (void *)&buffer);
+
+  GKeyParameters params = {
+    .in_buffer = in,
+    .in_size = sizeof(in),
+    .out_buffer = out,
+    .out_size = sizeof(out),
+  };
+
+  const GKeyStatus status = gkeydecomp_decompress(decomp, &params);
+  assert(status == GKeyStatus_OK);
+  assert(params.out_size == 0);
+  assert(memcmp(out, "ABABABAB", sizeof(out)) == 0);
+
+  gkeydecomp_destroy(decomp); /* does nothing */
+}
+
+static void count_lock(void *arg)
+{
+  int * const depth = arg;
+  assert(*depth == 0);
+  ++*depth;
+}
+
+static void count_unlock(void *arg)
+{
+  int * const depth = arg;
+  assert(*depth == 1);
+  --*depth;
+}
+
+static void test6(void)
+{
+  /* Pool */
+  int depth = 0;
+  const GKeyPoolLock lock = { count_lock, count_unlock, &depth };
+  GKeyDecomp *decomp[3];
+  GKeyPoolStats stats;
+
+  GKeyPool * const pool = gkeydecomp_pool_make(HistoryLog2, 2, NULL, &lock);
+  assert(pool != NULL);
+
+  for (size_t i = 0; i < ARRAY_SIZE(decomp); i++)
+  {
+    decomp[i] = gkeydecomp_pool_get(pool);
+    assert(decomp[i] != NULL);
+  }
+
+  /* The pool can only hold two, so the third is destroyed */
+  for (size_t i = 0; i < ARRAY_SIZE(decomp); i++)
+    gkeydecomp_pool_put(pool, decomp[i]);
+
+  GKey_pool_get_stats(pool, &stats);
+  assert(stats.hits == 0);
+  assert(stats.misses == ARRAY_SIZE(decomp));
+  assert(stats.nfree == 2);
+
+  GKeyDecomp * const reused = gkeydecomp_pool_get(pool);
+  assert(reused == decomp[1]);
+
+  GKey_pool_get_stats(pool, &stats);
+  assert(stats.hits == 1);
+  assert(stats.nfree == 1);
+  assert(depth == 0);
+
+  gkeydecomp_pool_put(pool, NULL);
+  gkeydecomp_destroy(reused);
+  GKey_pool_destroy(pool);
+  GKey_pool_destroy(NULL);
+}
+
+static void test7(void)
+{
+  /* Stream */
+  /* "ABABABAB" compressed with HistoryLog2 */
+  static const unsigned char in[] = {
+    0x82, 0x08, 0x09, 0x22, 0x94, 0xff, 0x00, 0x21
+  };
+  char out[16];
+  StreamState state = {
+    .in = in, .in_size = sizeof(in), .chunk_size = 1,
+    .out = (unsigned char *)out, .out_size = sizeof(out)
+  };
+  const GKeyStreamParameters params = {
+    .read_cb = stream_read,
+    .write_cb = stream_write,
+    .cb_arg = &state,
+  };
+
+  GKeyDecomp * const decomp = gkeydecomp_make(HistoryLog2);
+  assert(decomp != NULL);
+
+  assert(gkeydecomp_stream(decomp, &params) == GKeyStatus_OK);
+  assert(state.out_pos == 8);
+  assert(memcmp(out, "ABABABAB", state.out_pos) == 0);
+
+  /* Input that ends in the middle of a command */
+  gkeydecomp_reset(decomp);
+  state.in_size = 4;
+  state.in_pos = state.out_pos = 0;
+  assert(gkeydecomp_stream(decomp, &params) == GKeyStatus_TruncatedInput);
+
+  gkeydecomp_destroy(decomp);
+}
+
+static void test8(void)
+{
+  /* Vectors */
+  /* "ABABABAB" compressed with HistoryLog2 */
+  static const unsigned char in[] = {
+    0x82, 0x08, 0x09, 0x22, 0x94, 0xff, 0x00, 0x21
+  };
+  char out[8];
+  GKeyInVec in_vec[sizeof(in)];
+  GKeyOutVec out_vec[3];
+
+  /* One byte per input segment, so every command spans segments */
+  for (size_t i = 0; i < ARRAY_SIZE(in_vec); ++i)
+    in_vec[i] = (GKeyInVec){ in + i, 1 };
+
+  out_vec[0] = (GKeyOutVec){ out, 3 };
+  out_vec[1] = (GKeyOutVec){ out + 3, 0 };
+  out_vec[2] = (GKeyOutVec){ out + 3, 5 };
+
+  GKeyDecomp * const decomp = gkeydecomp_make(HistoryLog2);
+  assert(decomp != NULL);
+
+  GKeyVecParameters params = {
+    .in_vec = in_vec, .in_count = ARRAY_SIZE(in_vec),
+    .out_vec = out_vec, .out_count = ARRAY_SIZE(out_vec)
+  };
+  assert(gkeydecomp_decompress_vec(decomp, &params) == GKeyStatus_OK);
+  assert(params.in_count == 0);
+  assert(params.out_count == 0);
+  assert(memcmp(out, "ABABABAB", sizeof(out)) == 0);
+
+  /* Input that ends in the middle of a command */
+  gkeydecomp_reset(decomp);
+  params = (GKeyVecParameters){
+    .in_vec = in_vec, .in_count = 4,
+    .out_vec = out_vec, .out_count = ARRAY_SIZE(out_vec)
+  };
+  assert(gkeydecomp_decompress_vec(decomp, &params) ==
+         GKeyStatus_TruncatedInput);
+  assert(params.in_count == 0);
+
+  gkeydecomp_destroy(decomp);
+}
+
+static void test9(void)
+{
+  /* Cancellation */
+  /* "ABABABAB" compressed with HistoryLog2 */
+  static const unsigned char in[] = {
+    0x82, 0x08, 0x09, 0x22, 0x94, 0xff, 0x00, 0x21
+  };
+  volatile sig_atomic_t cancel = 1;
+  char out[8];
+
+  GKeyDecomp * const decomp = gkeydecomp_make(HistoryLog2);
+  assert(decomp != NULL);
+  gkeydecomp_set_progress(decomp, 0, &cancel);
+
+  GKeyParameters params = {
+    .in_buffer = in,
+    .in_size = sizeof(in),
+    .out_buffer = out,
+    .out_size = sizeof(out),
+  };
+
+  /* The flag is checked before the first command */
+  assert(gkeydecomp_decompress(decomp, &params) == GKeyStatus_Aborted);
+  assert(params.in_size == sizeof(in));
+
+  /* Checking less often allows the first commands to be decoded */
+  gkeydecomp_set_progress(decomp, 3, &cancel);
+  cancel = 0;
+  params.in_size = 1;
+  assert(gkeydecomp_decompress(decomp, &params) ==
+         GKeyStatus_TruncatedInput);
+  cancel = 1;
+  params.in_size = sizeof(in) - 1;
+  assert(gkeydecomp_decompress(decomp, &params) == GKeyStatus_Aborted);
+  assert(params.in_size > 0);
+  assert(params.out_size < sizeof(out));
+
+  cancel = 0;
+  assert(gkeydecomp_decompress(decomp, &params) == GKeyStatus_OK);
+  assert(params.out_size == 0);
+  assert(memcmp(out, "ABABABAB", sizeof(out)) == 0);
+
+  gkeydecomp_destroy(decomp);
+}
+
+static void test10(void)
+{
+  /* Budget */
+  /* "ABABABAB" compressed with HistoryLog2 */
+  static const unsigned char in[] = {
+    0x82, 0x08, 0x09, 0x22, 0x94, 0xff, 0x00, 0x21
+  };
+  char out[8];
+  GKeyInVec in_vec[sizeof(in)];
+  const GKeyOutVec out_vec[] = { { out, sizeof(out) } };
+
+  GKeyDecomp * const decomp = gkeydecomp_make(HistoryLog2);
+  assert(decomp != NULL);
+  gkeydecomp_set_budget(decomp, 3);
+
+  GKeyParameters params = {
+    .in_buffer = in,
+    .in_size = sizeof(in),
+    .out_buffer = out,
+    .out_size = sizeof(out),
+  };
+
+  /* Copies are split to keep within the budget */
+  assert(gkeydecomp_decompress(decomp, &params) == GKeyStatus_Suspended);
+  assert(params.out_size == sizeof(out) - 3);
+  assert(gkeydecomp_decompress(decomp, &params) == GKeyStatus_Suspended);
+  assert(params.out_size == sizeof(out) - 6);
+  assert(gkeydecomp_decompress(decomp, &params) == GKeyStatus_OK);
+  assert(params.out_size == 0);
+  assert(memcmp(out, "ABABABAB", sizeof(out)) == 0);
+
+  /* The budget applies to a whole call with many input segments */
+  gkeydecomp_reset(decomp);
+  memset(out, 0, sizeof(out));
+  for (size_t i = 0; i < ARRAY_SIZE(in_vec); ++i)
+    in_vec[i] = (GKeyInVec){ in + i, 1 };
+
+  GKeyVecParameters vparams = {
+    .in_vec = in_vec, .in_count = ARRAY_SIZE(in_vec),
+    .out_vec = out_vec, .out_count = ARRAY_SIZE(out_vec)
+  };
+  assert(gkeydecomp_decompress_vec(decomp, &vparams) ==
+         GKeyStatus_Suspended);
+  assert(vparams.out_offset == 3);
+  gkeydecomp_set_budget(decomp, 0);
+  assert(gkeydecomp_decompress_vec(decomp, &vparams) == GKeyStatus_OK);
+  assert(vparams.out_count == 0);
+  assert(memcmp(out, "ABABABAB", sizeof(out)) == 0);
+
+  gkeydecomp_destroy(decomp);
+}
+
+static void test11(void)
+{
+  /* Checksum */
+  /* "ABABABAB" compressed with HistoryLog2 */
+  static const unsigned char in[] = {
+    0x82, 0x08, 0x09, 0x22, 0x94, 0xff, 0x00, 0x21
+  };
+  static const unsigned long expected_crc = 0x94b093a4;
+  char out[8];
+
+  GKeyDecomp * const decomp = gkeydecomp_make(HistoryLog2);
+  assert(decomp != NULL);
+  gkeydecomp_set_checksum(decomp, true);
+  assert(gkeydecomp_get_checksum(decomp) == 0);
+
+  GKeyParameters params = {
+    .in_buffer = in,
+    .in_size = sizeof(in),
+    .out_buffer = out,
+    .out_size = sizeof(out),
+  };
+  assert(gkeydecomp_decompress(decomp, &params) == GKeyStatus_OK);
+  assert(memcmp(out, "ABABABAB", sizeof(out)) == 0);
+  assert(gkeydecomp_get_checksum(decomp) == expected_crc);
+
+  /* The checksum must not depend on how the output is split */
+  gkeydecomp_reset(decomp);
+  params = (GKeyParameters){ .in_buffer = in, .in_size = sizeof(in),
+                             .out_buffer = out };
+  for (size_t i = 0; i < sizeof(out); ++i)
+  {
+    params.out_size = 1;
+    assert(gkeydecomp_decompress(decomp, &params) ==
+           (i + 1 < sizeof(out) ? GKeyStatus_BufferOverflow : GKeyStatus_OK));
+  }
+  assert(gkeydecomp_get_checksum(decomp) == expected_crc);
+
+  /* It can be calculated without an output buffer */
+  gkeydecomp_reset(decomp);
+  params = (GKeyParameters){ .in_buffer = in, .in_size = sizeof(in) };
+  assert(gkeydecomp_decompress(decomp, &params) == GKeyStatus_OK);
+  assert(params.out_size == sizeof(out));
+  assert(gkeydecomp_get_checksum(decomp) == expected_crc);
+
+  gkeydecomp_destroy(decomp);
+}
+
 void GKeyDecomp_tests(void)
 {
   static const struct
@@ -88,6 +501,14 @@ void GKeyDecomp_tests(void)
     { "Make/destroy", test1 },
     { "Make fail recovery", test2 },
     { "Destroy null", test3 },
+    { "Allocator", test4 },
+    { "Placement", test5 },
+    { "Pool", test6 },
+    { "Stream", test7 },
+    { "Vectors", test8 },
+    { "Cancellation", test9 },
+    { "Budget", test10 },
+    { "Checksum", test11 },
   };
 
   for (size_t count = 0; count < ARRAY_SIZE(unit_tests); count ++)
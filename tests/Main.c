@@ -37,6 +37,7 @@ int main(int argc, char *argv[])
     { "GKeyComp", GKeyComp_tests },
     { "GKeyDecomp", GKeyDecomp_tests },
     { "RingBuffer", RingBuffer_tests },
+    { "RingIndex", RingIndex_tests },
   };
 
   NOT_USED(argc);
@@ -19,8 +19,10 @@
 
 /* ISO library headers */
 #include <limits.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 /* GKeyLib headers */
 #include "Internal/RingBuffer.h"
@@ -42,12 +44,12 @@ static void test1(void)
 
   for (size_t i = 0; i < ARRAY_SIZE(rb); i++)
   {
-    rb[i] = RingBuffer_make(HistoryLog2);
+    rb[i] = RingBuffer_make(HistoryLog2, NULL);
     assert(rb[i] != NULL);
   }
 
   for (size_t i = 0; i < ARRAY_SIZE(rb); i++)
-    RingBuffer_destroy(rb[i]);
+    RingBuffer_destroy(rb[i], NULL);
 }
 
 static void test2(void)
@@ -59,7 +61,7 @@ static void test2(void)
   for (limit = 0; limit < FortifyAllocationLimit; ++limit)
   {
     Fortify_SetNumAllocationsLimit(limit);
-    rb = RingBuffer_make(HistoryLog2);
+    rb = RingBuffer_make(HistoryLog2, NULL);
     Fortify_SetNumAllocationsLimit(ULONG_MAX);
 
     if (rb != NULL)
@@ -69,13 +71,13 @@ static void test2(void)
 
   assert(rb != NULL);
 
-  RingBuffer_destroy(rb);
+  RingBuffer_destroy(rb, NULL);
 }
 
 static void test3(void)
 {
   /* Destroy null */
-  RingBuffer_destroy(NULL);
+  RingBuffer_destroy(NULL, NULL);
 }
 
 static void test4(void)
@@ -88,6 +90,109 @@ static void test4(void)
   }
   free(rb);
 }
+
+static void test5(void)
+{
+  /* Mismatch */
+  static const char data[] = "0123456789abcdef0123456789abcdeX";
+  RingBuffer *rb = RingBuffer_make(HistoryLog2, NULL);
+  const size_t n = sizeof(data) - 1, half = n / 2;
+
+  assert(rb != NULL);
+
+  /* Make both strings wrap around the end of the buffer at different
+     places */
+  for (size_t i = 0; i < (1u << HistoryLog2) - half - 3; i++)
+    RingBuffer_write(rb, "", 1);
+
+  RingBuffer_write(rb, data, n);
+
+  const size_t offset1 = rb->size - n, offset2 = offset1 + half;
+  assert(RingBuffer_mismatch(rb, offset1, offset2, half) == half - 1);
+  assert(RingBuffer_mismatch(rb, offset1, offset2, half - 1) == half - 1);
+  assert(RingBuffer_mismatch(rb, offset1, offset2, 0) == 0);
+  assert(RingBuffer_mismatch(rb, 0, offset1, n) == 0);
+
+  RingBuffer_destroy(rb, NULL);
+}
+
+static void test6(void)
+{
+  /* Match */
+  static const char data[] = "0123456789abcdefghijklmnopqrstuv";
+  RingBuffer *rb = RingBuffer_make(HistoryLog2, NULL);
+  const size_t n = sizeof(data) - 1;
+
+  assert(rb != NULL);
+
+  /* Make the string wrap around the end of the buffer */
+  for (size_t i = 0; i < (1u << HistoryLog2) - 5; i++)
+    RingBuffer_write(rb, "", 1);
+
+  RingBuffer_write(rb, data, n);
+
+  const size_t offset = rb->size - n;
+  assert(RingBuffer_match(rb, offset, data, n) == n);
+  assert(RingBuffer_match(rb, offset, "0123456789abcdefghijklmnopqrstuX", n) == n - 1);
+  assert(RingBuffer_match(rb, offset, "012X", 4) == 3);
+  assert(RingBuffer_match(rb, offset, "X", 0) == 0);
+  assert(RingBuffer_match(rb, 0, "\0\0\0\0\0\0\0\0\0\0X", 11) == 10);
+
+  RingBuffer_destroy(rb, NULL);
+}
+
+static size_t check_zeros(void *arg, const void *s, size_t n)
+{
+  size_t *total = arg;
+  const unsigned char *chars = s;
+
+  for (size_t i = 0; i < n; i++)
+    assert(chars[i] == '\0');
+
+  *total += n;
+  return n;
+}
+
+static void test7(void)
+{
+  /* Reset */
+  static unsigned char zeros[1u << HistoryLog2];
+  RingBuffer *rb = RingBuffer_make(HistoryLog2, NULL);
+  const size_t size = 1u << HistoryLog2;
+  size_t total = 0;
+
+  assert(rb != NULL);
+
+  /* Fill the buffer with non-zero values then reset it without clearing */
+  for (size_t i = 0; i < size + 3; i++)
+    RingBuffer_write(rb, "\xaa", 1);
+
+  RingBuffer_reset(rb);
+  RingBuffer_write(rb, "abc", 3);
+
+  /* Everything except the characters just written must read as zero */
+  assert(RingBuffer_read_char(rb, 0) == '\0');
+  assert(RingBuffer_read_char(rb, size - 4) == '\0');
+  assert(RingBuffer_read_char(rb, size - 3) == 'a');
+  assert(RingBuffer_find_char(rb, 0, size - 3, 0xaa) == SIZE_MAX);
+  assert(RingBuffer_find_char(rb, 0, size - 3, '\0') == 0);
+  assert(RingBuffer_find_char(rb, 0, size, 'b') == size - 2);
+  assert(RingBuffer_compare(rb, 0, size / 2, size / 2 - 3) == 0);
+  assert(RingBuffer_compare(rb, size - 4, size - 3, 2) < 0);
+  assert(RingBuffer_mismatch(rb, 0, size - 5, 3) == 2);
+  assert(RingBuffer_match(rb, 0, zeros, size - 3) == size - 3);
+  assert(RingBuffer_match(rb, size - 4, zeros, 4) == 1);
+
+  /* Copying unwritten characters must write zeros */
+  assert(RingBuffer_copy(rb, check_zeros, &total, 0, size - 4) == size - 4);
+  assert(total == size - 4);
+  assert(RingBuffer_read_char(rb, size - 1) == '\0');
+  assert(RingBuffer_read_char(rb, 3) == 'c');
+  assert(RingBuffer_match(rb, size - 4, zeros, 4) == 4);
+
+  RingBuffer_destroy(rb, NULL);
+}
+
 void RingBuffer_tests(void)
 {
   static const struct
@@ -101,6 +206,9 @@ void RingBuffer_tests(void)
     { "Make fail recovery", test2 },
     { "Destroy null", test3 },
     { "Initialise", test4 },
+    { "Mismatch", test5 },
+    { "Match", test6 },
+    { "Reset", test7 },
   };
 
   for (size_t count = 0; count < ARRAY_SIZE(unit_tests); count ++)
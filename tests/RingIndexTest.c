@@ -0,0 +1,145 @@
+/*
+ * GKeyLib test: Ring buffer character index
+ * Copyright (C) 2026 Christopher Bazley
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/* ISO library headers */
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+
+/* GKeyLib headers */
+#include "Internal/RingBuffer.h"
+#include "Internal/RingIndex.h"
+
+/* Local headers */
+#include "Tests.h"
+
+enum
+{
+  NumberOfIndexes = 5,
+  HistoryLog2 = 9,
+  FortifyAllocationLimit = 2048
+};
+
+static void test1(void)
+{
+  /* Make/destroy */
+  RingIndex *index[NumberOfIndexes];
+
+  for (size_t i = 0; i < ARRAY_SIZE(index); i++)
+  {
+    index[i] = RingIndex_make(HistoryLog2, NULL);
+    assert(index[i] != NULL);
+  }
+
+  for (size_t i = 0; i < ARRAY_SIZE(index); i++)
+    RingIndex_destroy(index[i], NULL);
+}
+
+static void test2(void)
+{
+  /* Make fail recovery */
+  RingIndex *index = NULL;
+  unsigned long limit;
+
+  for (limit = 0; limit < FortifyAllocationLimit; ++limit)
+  {
+    Fortify_SetNumAllocationsLimit(limit);
+    index = RingIndex_make(HistoryLog2, NULL);
+    Fortify_SetNumAllocationsLimit(ULONG_MAX);
+
+    if (index != NULL)
+      break;
+  }
+  assert(limit != FortifyAllocationLimit);
+
+  assert(index != NULL);
+
+  RingIndex_destroy(index, NULL);
+}
+
+static void test3(void)
+{
+  /* Destroy null */
+  RingIndex_destroy(NULL, NULL);
+}
+
+static void test4(void)
+{
+  /* Match longest oldest sequence */
+  static const char history[] = "abcabdabcab";
+  static const char input[] = "abcabx";
+  RingBuffer *rb = RingBuffer_make(HistoryLog2, NULL);
+  RingIndex *index = RingIndex_make(HistoryLog2, NULL);
+  const size_t n = strlen(history);
+  size_t matched;
+
+  assert(rb != NULL);
+  assert(index != NULL);
+
+  RingIndex_remove(index, rb, 0, n);
+  RingBuffer_write(rb, history, n);
+  RingIndex_add(index, rb, rb->size - n, n);
+
+  /* "abcab" occurs twice but the second instance can't be copied in full
+     because it includes the most recently written character. */
+  for (matched = 0; matched < sizeof(input) - 1; matched++)
+  {
+    if (!RingIndex_match_next(index, rb, matched, input[matched]))
+      break;
+  }
+  assert(matched == 5);
+  assert(RingIndex_match_offset(index, rb, matched) == rb->size - n);
+
+  /* Only nul characters can be matched in the region not yet written */
+  assert(RingIndex_match_next(index, rb, 0, '\0'));
+  assert(RingIndex_match_offset(index, rb, 1) == 0);
+
+  RingIndex_destroy(index, NULL);
+  RingBuffer_destroy(rb, NULL);
+}
+
+void RingIndex_tests(void)
+{
+  static const struct
+  {
+    const char *test_name;
+    void (*test_func)(void);
+  }
+  unit_tests[] =
+  {
+    { "Make/destroy", test1 },
+    { "Make fail recovery", test2 },
+    { "Destroy null", test3 },
+    { "Match", test4 },
+  };
+
+  for (size_t count = 0; count < ARRAY_SIZE(unit_tests); count ++)
+  {
+    printf("Test %zu/%zu : %s\n",
+           1 + count,
+           ARRAY_SIZE(unit_tests),
+           unit_tests[count].test_name);
+
+    Fortify_EnterScope();
+
+    unit_tests[count].test_func();
+
+    Fortify_LeaveScope();
+  }
+}
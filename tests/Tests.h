@@ -48,5 +48,6 @@
 extern void GKeyComp_tests(void);
 extern void GKeyDecomp_tests(void);
 extern void RingBuffer_tests(void);
+extern void RingIndex_tests(void);
 
 #endif /* Tests_h */
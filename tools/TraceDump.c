@@ -0,0 +1,181 @@
+/*
+ * GKeyLib tool: Decoder for saved event traces
+ * Copyright (C) 2026 Christopher Bazley
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/* ISO library headers */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+/* GKeyLib headers */
+#include "GKey.h"
+
+enum
+{
+  HeaderSize = 16, /* No. of bytes in the header of a saved trace */
+  EventSize = 16,  /* No. of bytes per event in a saved trace */
+  TraceVersion = 1 /* Version of the format understood by this tool */
+};
+
+/* These must match the enumerations of states in GKeyComp.c and
+   GKeyDecomp.c. The compressor's first state has the value -1. */
+static const char *const comp_states[] =
+{
+  "NextSequence", "Progress", "FindSequence", "PutOffset", "PutSize",
+  "PutByte", "PutBytes", "Flush"
+};
+
+static const char *const decomp_states[] =
+{
+  "Progress", "GetType", "GetOffset", "GetSize", "CopyData", "GetByte",
+  "PutByte"
+};
+
+static const char *const statuses[] =
+{
+  "OK", "BadInput", "TruncatedInput", "BufferOverflow", "Aborted",
+  "Finished", "NoMem", "Suspended", "VerifyFailed"
+};
+
+static uint32_t get_word(const unsigned char *p)
+{
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+         ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static const char *get_state_str(unsigned int source, int state)
+{
+  if (source == GKeyTraceSource_Comp)
+  {
+    if (state >= -1 && state + 1 < (int)(sizeof(comp_states) /
+                                         sizeof(comp_states[0])))
+      return comp_states[state + 1];
+  }
+  else if (source == GKeyTraceSource_Decomp)
+  {
+    if (state >= 0 && state < (int)(sizeof(decomp_states) /
+                                    sizeof(decomp_states[0])))
+      return decomp_states[state];
+  }
+  return "?";
+}
+
+static void print_event(unsigned long index, const unsigned char *p)
+{
+  const unsigned int type = p[0], source = p[1];
+  const int state = (signed char)p[2];
+  const uint32_t pos = get_word(p + 4), arg1 = get_word(p + 8),
+                 arg2 = get_word(p + 12);
+
+  printf("%8lu %-6s %10lu %-14s ", index,
+         source == GKeyTraceSource_Comp ? "comp" :
+         source == GKeyTraceSource_Decomp ? "decomp" : "?",
+         (unsigned long)pos, get_state_str(source, state));
+
+  switch (type)
+  {
+    case GKeyTraceType_Call:
+      printf("call in %lu out %lu\n", (unsigned long)arg1,
+             (unsigned long)arg2);
+      break;
+
+    case GKeyTraceType_Return:
+      printf("return %s out %lu\n",
+             arg1 < sizeof(statuses) / sizeof(statuses[0]) ?
+               statuses[arg1] : "?", (unsigned long)arg2);
+      break;
+
+    case GKeyTraceType_State:
+      printf("state from %s\n", get_state_str(source, (int32_t)arg1));
+      break;
+
+    case GKeyTraceType_Literal:
+      printf("literal 0x%02lx\n", (unsigned long)arg1);
+      break;
+
+    case GKeyTraceType_Literals:
+      printf("literals offset %lu size %lu\n", (unsigned long)arg1,
+             (unsigned long)arg2);
+      break;
+
+    case GKeyTraceType_Copy:
+      printf("copy offset %lu size %lu\n", (unsigned long)arg1,
+             (unsigned long)arg2);
+      break;
+
+    case GKeyTraceType_Stall:
+      printf("stall offset %lu size %lu\n", (unsigned long)arg1,
+             (unsigned long)arg2);
+      break;
+
+    default:
+      printf("unknown event %u (%lu, %lu)\n", type, (unsigned long)arg1,
+             (unsigned long)arg2);
+      break;
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  unsigned char header[HeaderSize], event[EventSize];
+  unsigned long count, dropped;
+  FILE *f;
+
+  if (argc != 2)
+  {
+    fprintf(stderr, "Usage: TraceDump <file>\n");
+    return EXIT_FAILURE;
+  }
+
+  f = fopen(argv[1], "rb");
+  if (f == NULL)
+  {
+    perror(argv[1]);
+    return EXIT_FAILURE;
+  }
+
+  if (fread(header, sizeof(header), 1, f) != 1 ||
+      memcmp(header, "GKTR", 4) != 0 || header[4] != TraceVersion ||
+      header[5] != EventSize)
+  {
+    fprintf(stderr, "%s is not a trace in a supported format\n", argv[1]);
+    fclose(f);
+    return EXIT_FAILURE;
+  }
+
+  count = get_word(header + 8);
+  dropped = get_word(header + 12);
+  printf("%lu events (%lu earlier events were overwritten)\n",
+         count, dropped);
+
+  for (unsigned long i = 0; i < count; ++i)
+  {
+    if (fread(event, sizeof(event), 1, f) != 1)
+    {
+      fprintf(stderr, "%s is truncated\n", argv[1]);
+      fclose(f);
+      return EXIT_FAILURE;
+    }
+    /* Number events from the start of tracing, including overwritten ones */
+    print_event(dropped + i, event);
+  }
+
+  fclose(f);
+  return EXIT_SUCCESS;
+}